@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <limits>
 
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/multi_index.hpp>
 #include <eosio/permission.hpp>
@@ -16,6 +18,7 @@
 #include "daccustodian_shared.hpp"
 #include "eosdactokens_shared.hpp"
 #include "external_types.hpp"
+#include "logging.hpp"
 
 using namespace std;
 
@@ -29,6 +32,20 @@ namespace eosdac {
 #ifndef TRANSFER_DELAY
 #define TRANSFER_DELAY 60 * 60
 #endif
+
+    // Number of rows a single newperiod call may process while finishing a pending period, unless overridden per DAC
+    // with setperiodbat.
+    static constexpr uint32_t DEFAULT_PERIOD_BATCH_SIZE = 100;
+
+    // Stages of finishing a pending period. Each stage is bounded by the batch size and resumes from period_cursor on
+    // the next newperiod call when it runs out of budget.
+    enum period_stage : uint8_t {
+        PERIOD_STAGE_IDLE   = 0, // No period is being finished, the next newperiod starts with the quorum checks
+        PERIOD_STAGE_PAY    = 1, // Accruing pay for the outgoing custodians
+        PERIOD_STAGE_RETIRE = 2, // Erasing custodians that were not re-elected
+        PERIOD_STAGE_ELECT  = 3, // Moving pending custodians into custodians1
+        PERIOD_STAGE_AUTH   = 4, // Updating the DAC authority for the new custodians
+    };
     struct [[eosio::table("custodians1"), eosio::contract("daccustodian")]] custodian {
         eosio::name           cust_name;
         eosio::asset          requestedpay;
@@ -64,6 +81,45 @@ namespace eosdac {
         eosio::indexed_by<"bydecayed"_n, eosio::const_mem_fun<custodian, uint64_t, &custodian::by_decayed_votes>>,
         eosio::indexed_by<"byreqpay"_n, eosio::const_mem_fun<custodian, uint64_t, &custodian::by_requested_pay>>>;
 
+    // The names in custodians1, republished by daccustodian whenever custodians1 changes so that other contracts can
+    // check membership with a single row read and tell from the generation whether the custodians changed.
+    struct [[eosio::table("custset"), eosio::contract("daccustodian")]] custodian_set {
+        uint64_t                 generation = 0; // 0 until the set is first published
+        std::vector<eosio::name> custodians;     // sorted
+
+        bool contains(const eosio::name account) const {
+            return std::binary_search(custodians.begin(), custodians.end(), account);
+        }
+    };
+    using custodian_set_container = eosio::singleton<"custset"_n, custodian_set>;
+
+    // DACs that have not finished a period since custset was introduced have no published set yet, for those it is
+    // read from custodians1.
+    inline custodian_set get_custodian_set(const eosio::name custodian_contract, const eosio::name dac_id) {
+        const auto published = custodian_set_container{custodian_contract, dac_id.value};
+        if (published.exists()) {
+            return published.get();
+        }
+
+        auto       set        = custodian_set{};
+        const auto custodians = custodians_table{custodian_contract, dac_id.value};
+        for (const auto &cust : custodians) {
+            set.custodians.push_back(cust.cust_name);
+        }
+        return set;
+    }
+
+    inline bool is_custodian(
+        const eosio::name custodian_contract, const eosio::name dac_id, const eosio::name account) {
+        const auto published = custodian_set_container{custodian_contract, dac_id.value};
+        if (published.exists()) {
+            return published.get().contains(account);
+        }
+
+        const auto custodians = custodians_table{custodian_contract, dac_id.value};
+        return custodians.find(account.value) != custodians.end();
+    }
+
     struct [[eosio::table("candidates"), eosio::contract("daccustodian")]] candidate {
         eosio::name           candidate_name;
         eosio::asset          requestedpay;
@@ -75,11 +131,47 @@ namespace eosdac {
         eosio::time_point_sec avg_vote_time_stamp;
         uint128_t             running_weight_time; // The running sum of weight*time from all votes for this candidate
 
+        static constexpr uint8_t  LOG2_FRAC_BITS = 48;
+        static constexpr uint64_t RANK_SCALE     = 10000; // to keep sub-integer precision of the index in a uint64_t
+
+        // log2(x) for x > 0 as a fixed point number with LOG2_FRAC_BITS fractional bits. The mantissa is kept in Q62
+        // and squared once per fractional bit: whenever the square reaches 2 that bit of the logarithm is set.
+        static uint64_t log2_fixed(const uint64_t x) {
+            const auto int_part = uint8_t(63 - __builtin_clzll(x));
+            auto       result   = uint64_t{int_part} << LOG2_FRAC_BITS;
+            auto       mantissa = (uint128_t{x} << 62) >> int_part;
+            for (auto bit = uint64_t{1} << (LOG2_FRAC_BITS - 1); bit != 0; bit >>= 1) {
+                mantissa = (mantissa * mantissa) >> 62;
+                if (mantissa >= (uint128_t{2} << 62)) {
+                    mantissa >>= 1;
+                    result |= bit;
+                }
+            }
+            return result;
+        }
+
+        // floor((log2(total_vote_power + 1) + avg_vote_time_stamp / SECONDS_TO_DOUBLE) * RANK_SCALE) in integer
+        // arithmetic, as floating point is emulated in WASM and this runs on every vote weight change. It matches the
+        // former double implementation except where that one rounded across an integer, i.e. for vote powers close
+        // below 2^49 and above, or when the exact result is an integer.
         uint64_t calc_decayed_votes_index() const {
+            auto err = Err{"calc_decayed_votes_index"};
+
+            // log(0) is -infinity, so we always add 1. This does not change the order of the index.
+            const auto log_arg = S{total_vote_power} + S{1ull};
+            const auto log     = uint128_t{log2_fixed(log_arg.to<uint64_t>())};
+            const auto numerator =
+                (log * SECONDS_TO_DOUBLE + (uint128_t{avg_vote_time_stamp.sec_since_epoch()} << LOG2_FRAC_BITS)) *
+                RANK_SCALE;
+            return static_cast<uint64_t>(numerator / (uint128_t{SECONDS_TO_DOUBLE} << LOG2_FRAC_BITS));
+        }
+
+#if defined(IS_DEV) || defined(DEBUG)
+        // Reference implementation calc_decayed_votes_index is checked against (see checkrank)
+        uint64_t calc_decayed_votes_index_double() const {
             auto       err            = Err{"calc_decayed_votes_index"};
             const auto scaling_factor = S{10000.0}; // to improve accuracy of index when converting double to uint64_t
 
-            // log(0) is -infinity, so we always add 1. This does not change the order of the index.
             const auto log_arg = S{total_vote_power} + S{1ull};
             const auto log     = log2(log_arg.to<double>());
             const auto x =
@@ -87,13 +179,17 @@ namespace eosdac {
                 scaling_factor;
             return x.to<uint64_t>();
         }
+#endif
 
         uint64_t by_decayed_votes() const {
             return std::numeric_limits<uint64_t>::max() - rank;
         }
 
+        // Inactive candidates keep their votes but get a rank of zero, so they sink to the end of the bydecayed index
+        // and electing the top candidates never has to walk past them.
+        // Only needs to be called once per modify, after total_vote_power and avg_vote_time_stamp are final.
         void update_index() {
-            rank = calc_decayed_votes_index();
+            rank = is_active ? calc_decayed_votes_index() : 0;
         }
 
         uint64_t primary_key() const {
@@ -279,8 +375,12 @@ namespace eosdac {
             indexed_by<"receiversym"_n, const_mem_fun<pay, checksum256, &pay::byreceiver_and_symbol>>>;
 
     struct [[eosio::table("candperms"), eosio::contract("daccustodian")]] candperm {
-        name cand;
-        name permission;
+        name                                    cand;
+        name                                    permission;
+        // Cached result of permissionExists for permission and when it was checked. Rows created before these fields
+        // existed have no cached result and are checked on every auth rebuild until revalperm is run for them.
+        binary_extension<bool>                  permission_exists;
+        binary_extension<eosio::time_point_sec> validated_at;
 
         uint64_t primary_key() const {
             return cand.value;
@@ -329,9 +429,61 @@ namespace eosdac {
             PROPERTY_OPTIONAL_TYPECASTING(bool, bool, requires_whitelist);
             PROPERTY_OPTIONAL_TYPECASTING(asset, asset, prop_budget_amount);
             PROPERTY_OPTIONAL_TYPECASTING(asset, asset, spendings_budget_amount);
+            PROPERTY_OPTIONAL_TYPECASTING(uint64_t, uint64_t, auth_fingerprint); // Fingerprint of the last authority set by setMsigAuths
+            PROPERTY_OPTIONAL_TYPECASTING(uint32_t, uint32_t, period_batch_size);
+            PROPERTY_OPTIONAL_TYPECASTING(uint8_t, uint8_t, period_stage); // See period_stage, unset when idle
+            PROPERTY_OPTIONAL_TYPECASTING(uint64_t, uint64_t, period_cursor); // Next custodian to process in the current stage
+            PROPERTY_OPTIONAL_TYPECASTING(uint8_t, uint8_t, period_new_custodians); // Newcomers counted so far in PERIOD_STAGE_ELECT
+            PROPERTY_OPTIONAL_TYPECASTING(extended_asset, extended_asset, period_mean_pay); // Mean pay fixed for the current PERIOD_STAGE_PAY
+            PROPERTY_OPTIONAL_TYPECASTING(bool, bool, pay_ledger_mode); // Keep claimed pendingpay rows at zero instead of erasing them
     )
     // clang-format on
 
+    static int128_t vote_weight_time(const int64_t weight, const eosio::time_point_sec vote_time_stamp) {
+        return S{weight}.to<int128_t>() * S{vote_time_stamp.sec_since_epoch()}.to<int128_t>();
+    }
+
+    /**
+     * Accumulated change to a single candidate while folding a batch of weight deltas, applied with one modify.
+     */
+    struct candidate_weight_delta {
+        int64_t  weight          = 0;
+        int128_t weight_time     = 0;
+        uint32_t negative_deltas = 0; // Each of them could have been clamped at zero on its own, see applyVoteWeight
+    };
+
+    /**
+     * Action scoped view of a single DAC. The directory entry and the globals singleton are loaded on first use and
+     * then shared by every helper in the call tree, so they are only deserialized once per action. Changes made to
+     * the globals are written back once when the context goes out of scope at the end of the action.
+     */
+    struct dac_context {
+        const eosio::name self;
+        const eosio::name dac_id;
+
+        dac_context(const eosio::name self, const eosio::name dac_id) : self(self), dac_id(dac_id) {}
+        dac_context(const dac_context &)            = delete;
+        dac_context &operator=(const dac_context &) = delete;
+
+        const dacdir::dac &get_dac() {
+            if (!dac) {
+                dac = dacdir::dac_for_id(dac_id);
+            }
+            return *dac;
+        }
+
+        dacglobals &get_globals() {
+            if (!globals) {
+                globals.emplace(self, dac_id);
+            }
+            return *globals;
+        }
+
+      private:
+        std::optional<dacdir::dac> dac;
+        std::optional<dacglobals>  globals;
+    };
+
     class daccustodian : public contract {
 
       public:
@@ -344,6 +496,7 @@ namespace eosdac {
         ACTION balanceobsv(const vector<account_balance_delta> &account_balance_deltas, const name &dac_id);
         ACTION stakeobsv(const vector<account_stake_delta> &account_stake_deltas, const name &dac_id);
         ACTION weightobsv(const vector<account_weight_delta> &account_weight_deltas, const name &dac_id);
+        ACTION stakewtobsv(const vector<account_stake_weight_delta> &account_stake_weight_deltas, const name &dac_id);
 
         ACTION nominatecane(const name &cand, const eosio::asset &requestedpay, const name &dac_id);
         ACTION nominate(const name &cand, const name &dac_id);
@@ -382,6 +535,11 @@ namespace eosdac {
             const uint8_t &maxvotes, const uint8_t &numelected, const uint8_t &auththreshold, const name &dac_id);
         ACTION setlockdelay(const uint32_t &lockup_release_time_delay, const name &dac_id);
         ACTION setpaymax(const eosio::extended_asset &requested_pay_max, const name &dac_id);
+        ACTION setperiodbat(const uint32_t &batch_size, const name &dac_id);
+        ACTION setpayledger(const bool &enabled, const name &dac_id);
+        // Forgets the fingerprint of the last authority so the next newperiod re-applies it, e.g. after it was edited
+        // outside this contract.
+        ACTION resetauths(const name &dac_id);
         ACTION settokensup(const uint64_t &token_supply_theshold, const name &dac_id);
         ACTION setbudget(const name &dac_id, const uint16_t percentage);
         ACTION setprpbudget(const name &dac_id, const uint16_t percentage);
@@ -392,6 +550,7 @@ namespace eosdac {
         ACTION addwl(name cand, uint64_t rating, name dac_id);
         ACTION updwl(name cand, uint64_t rating, name dac_id);
         ACTION rmvwl(name cand, name dac_id);
+        ACTION rerankcands(const name &dac_id, const name &from, const uint16_t batch_size);
 
 #ifdef DEBUG
         ACTION migratestate(const name &dac_id);
@@ -413,6 +572,8 @@ namespace eosdac {
 #if defined(IS_DEV) || defined(DEBUG)
         ACTION migraterank(const name &dac_id);
         ACTION clearrank(const name &dac_id);
+        // Asserts that the integer rank matches the double one for each {total_vote_power, avg_vote_time_stamp} pair
+        ACTION checkrank(const vector<pair<uint64_t, uint32_t>> &samples);
 #endif
 
 #ifdef IS_DEV
@@ -426,6 +587,17 @@ namespace eosdac {
                 c.cust_name    = cust;
                 c.requestedpay = ZERO_TRILIUM;
             });
+            publishCustodianSet(dac_id);
+        };
+
+        // helper function for testing to add a candperms row as written before the permission check was cached
+        ACTION tstlegperm(const name cand, const name permission, const name dac_id) {
+            require_auth(get_self());
+            auto cand_perms = candperms_table{get_self(), dac_id.value};
+            cand_perms.emplace(get_self(), [&](candperm &c) {
+                c.cand       = cand;
+                c.permission = permission;
+            });
         };
 
 #endif
@@ -446,34 +618,62 @@ namespace eosdac {
          */
         ACTION setperm(const name &cand, const name &permission, const name &dac_id);
 
+        /**
+         * This action re-checks that the custom permission registered with setperm still exists and caches the result.
+         * It should be called after a candidate changes or removes the permission on their account. It only re-reads
+         * chain state, so anyone may call it. The contract pays for the row unless the candidate authorised the call.
+         *
+         * ### Assertions:
+         * - The candidate has a custom permission registered via setperm
+         *
+         * @param cand - The account id for the candidate whose custom permission should be re-validated.
+         *
+         *
+         * ### Post Condition:
+         * The cached permission check for the candidate is updated. If the result changed the next auth rebuild will
+         * not be skipped.
+         */
+        ACTION revalperm(const name &cand, const name &dac_id);
+
       private: // Private helper methods used by other actions.
-        void updateVoteWeight(
-            name custodian, const time_point_sec vote_time_stamp, int64_t weight, name dac_id, bool from_voting);
-        void updateVoteWeights(const vector<name> &votes, const time_point_sec vote_time_stamp, int64_t vote_weight,
-            name internal_dac_id, bool from_voting);
-        std::pair<int64_t, int64_t> get_vote_weight(name voter, name dac_id);
+        void applyVoteWeight(
+            candidate &c, const int64_t weight, const int128_t weight_time, const uint32_t negative_deltas = 1);
+        void updateVoteWeight(candidates_table &registered_candidates, name custodian,
+            const time_point_sec vote_time_stamp, int64_t weight, int32_t voters_delta);
+        void moveVoteWeight(candidates_table &registered_candidates, name custodian, int64_t weight,
+            const time_point_sec old_time_stamp, const time_point_sec new_time_stamp);
+        void applyCandidateWeightDeltas(
+            candidates_table &registered_candidates, const std::map<name, candidate_weight_delta> &deltas);
+        std::pair<int64_t, int64_t> get_vote_weight(name voter, dac_context &ctx);
         void                        modifyVoteWeights(const account_weight_delta &awd, const vector<name> &oldVotes,
                                    const std::optional<time_point_sec> &oldVoteTimestamp, const vector<name> &newVotes,
-                                   time_point_sec new_time_stamp, const name dac_id, const bool from_voting);
-        void modifyProxiesWeight(int64_t vote_weight, name oldProxy, name newProxy, name dac_id, bool from_voting);
+                                   time_point_sec new_time_stamp, dac_context &ctx, const bool from_voting);
+        void modifyProxiesWeight(int64_t vote_weight, name oldProxy, name newProxy, dac_context &ctx, bool from_voting);
+        void observeWeights(const vector<account_weight_delta> &account_weight_deltas, dac_context &ctx);
+        void observeStakes(const vector<account_stake_delta> &account_stake_deltas, dac_context &ctx);
         void assertPeriodTime(const dacglobals &globals);
         void assertPendingPeriodTime(const dacglobals &globals);
-        void distributeMeanPay(name internal_dac_id);
+        bool distributeMeanPay(dac_context &ctx, uint32_t &budget);
         vector<eosiosystem::permission_level_weight> get_perm_level_weights(
             const custodians_table &custodians, const name &dac_id);
         void add_all_auths(const name &accountToChange, const vector<eosiosystem::permission_level_weight> &weights,
-            const name &dac_id, const bool msig = false);
+            dac_context &ctx, const bool msig = false);
         void add_all_auths_msig(
             const name &accountToChange, vector<eosiosystem::permission_level_weight> &weights, const name &dac_id);
         void add_auth_to_account(const name &accountToChange, const uint8_t threshold, const name &permission,
             const name &parent, vector<eosiosystem::permission_level_weight> weights, const bool msig = false);
-        void setMsigAuths(name dac_id);
+        void setMsigAuths(dac_context &ctx);
+        void publishCustodianSet(const name &dac_id);
+        uint64_t auth_fingerprint(
+            const custodians_table &custodians, const name &accountToChange, const bool msig, dac_context &ctx);
         void transferCustodianBudget(const dacdir::dac &dac);
-        void removeCustodian(name cust, name internal_dac_id);
-        void disableCandidate(name cust, name internal_dac_id);
-        void prepareCustodians(name internal_dac_id);
+        void removeCustodian(name cust, dac_context &ctx);
+        void disableCandidate(name cust, dac_context &ctx);
+        void prepareCustodians(dac_context &ctx);
         bool periodIsPending(name internal_dac_id);
-        void allocateCustodians(name internal_dac_id);
+        bool retireCustodians(dac_context &ctx, uint32_t &budget);
+        bool allocateCustodians(dac_context &ctx, uint32_t &budget);
+        void runPeriodStages(dac_context &ctx);
         bool permissionExists(name account, name permission);
         bool _check_transaction_authorization(const char *trx_data, uint32_t trx_size, const char *pubkeys_data,
             uint32_t pubkeys_size, const char *perms_data, uint32_t perms_size);
@@ -481,8 +681,7 @@ namespace eosdac {
         permission_level getCandidatePermission(name account, name internal_dac_id);
         void             validateUnstake(name code, name cand, name dac_id);
         void validateUnstakeAmount(const name &code, const name &cand, const asset &unstake_amount, const name &dac_id);
-        void validateMinStake(name account, name dac_id);
-        void update_number_of_votes(const vector<name> &oldvotes, const vector<name> &newvotes, const name &dac_id);
+        void validateMinStake(name account, dac_context &ctx);
 
         bool maintenance_mode() {
             const auto globals = dacglobals{get_self(), get_self()};
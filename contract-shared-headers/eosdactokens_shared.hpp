@@ -2,6 +2,7 @@
 
 #include "contracts-common/util.hpp"
 #include "dacdirectory_shared.hpp"
+#include "logging.hpp"
 #include "eosio/eosio.hpp"
 #include <eosio/asset.hpp>
 
@@ -45,6 +46,16 @@ namespace eosdac {
         int64_t     weight_delta_quorum;
     };
 
+    // Stake delta together with the vote weight deltas derived from it, so the vote weight contract can hand both to
+    // the custodian contract in a single stakewtobsv notification.
+    struct account_stake_weight_delta {
+        eosio::name  account;
+        eosio::asset stake_delta;
+        uint32_t     unstake_delay;
+        int64_t      weight_delta;
+        int64_t      weight_delta_quorum;
+    };
+
     // This is a reference to the member struct as used in the eosdactoken contract.
     // @abi table members
     struct member {
@@ -70,6 +81,13 @@ namespace eosdac {
 
     using memterms = eosio::multi_index<"memberterms"_n, termsinfo>;
 
+    // Version of the latest member terms of a dac, kept by newmemterms so that validating members does not need to seek
+    // to the end of the memberterms table.
+    struct [[eosio::table("termsver"), eosio::contract("eosdactokens")]] terms_version {
+        uint64_t version = 0;
+    };
+    using terms_version_container = eosio::singleton<"termsver"_n, terms_version>;
+
     struct account {
         eosio::asset balance;
 
@@ -123,6 +141,22 @@ namespace eosdac {
     using unstakes_table = multi_index<"unstakes"_n, unstake_info,
         indexed_by<"byaccount"_n, const_mem_fun<unstake_info, uint64_t, &unstake_info::by_account>>>;
 
+    // Running total of the rows an account has in the unstakes table, so the liquid balance does not need to walk them.
+    // No row of the account is released before next_release.
+    struct [[eosio::table("unstaketots"), eosio::contract("eosdactokens")]] unstake_total {
+        name           account;
+        asset          pending;
+        time_point_sec next_release;
+
+        uint64_t primary_key() const {
+            return account.value;
+        }
+    };
+    using unstake_totals_table = multi_index<"unstaketots"_n, unstake_total>;
+
+    // Maximum number of unstake rows visited when collecting released unstakes in one action
+    static constexpr uint16_t UNSTAKE_COLLECT_BATCH = 50;
+
     struct staketime_info;
     using staketimes_table = multi_index<"staketime"_n, staketime_info>;
 
@@ -166,38 +200,145 @@ namespace eosdac {
         }
     }
 
-    asset get_liquid(name owner, name code, symbol sym) {
-        // Hardcoding a precision of 4, it doesnt matter because the index ignores precision
-        dacdir::dac dac = dacdir::dac_for_symbol(extended_symbol{sym, code});
+    /**
+     * Creates the unstake total of an account that had unstakes before the totals were tracked. This walks the unstakes
+     * of the account once; afterwards the total is kept up to date by add_unstake_total / sub_unstake_total.
+     */
+    void init_unstake_total(name owner, name code, const dacdir::dac &dac) {
+        unstake_totals_table totals(code, dac.dac_id.value);
+        if (totals.find(owner.value) != totals.end()) {
+            return;
+        }
 
-        stakes_table   stakes(code, dac.dac_id.value);
         unstakes_table unstakes(code, dac.dac_id.value);
         auto           unstakes_idx = unstakes.get_index<"byaccount"_n>();
+        auto           unstakes_itr = unstakes_idx.find(owner.value);
+        if (unstakes_itr == unstakes_idx.end()) {
+            return;
+        }
 
-        asset liquid = get_balance(owner, code, sym.code());
+        auto pending      = asset{0, dac.symbol.get_symbol()};
+        auto next_release = time_point_sec::maximum();
+        while (unstakes_itr != unstakes_idx.end() && unstakes_itr->account == owner) {
+            pending += unstakes_itr->stake;
+            next_release = std::min(next_release, unstakes_itr->release_time);
+            unstakes_itr++;
+        }
 
-        auto canDeleteStakeTime = true;
+        totals.emplace(owner, [&](unstake_total &t) {
+            t.account      = owner;
+            t.pending      = pending;
+            t.next_release = next_release;
+        });
+    }
 
-        auto existing_stake = stakes.find(owner.value);
-        if (existing_stake != stakes.end()) {
-            liquid -= existing_stake->stake;
-            canDeleteStakeTime = false;
+    // Must be called before the unstake row is added
+    void add_unstake_total(name owner, name code, const dacdir::dac &dac, asset stake, time_point_sec release_time) {
+        init_unstake_total(owner, code, dac);
+
+        unstake_totals_table totals(code, dac.dac_id.value);
+        auto                 total = totals.find(owner.value);
+        if (total == totals.end()) {
+            totals.emplace(owner, [&](unstake_total &t) {
+                t.account      = owner;
+                t.pending      = stake;
+                t.next_release = release_time;
+            });
+        } else {
+            totals.modify(total, same_payer, [&](unstake_total &t) {
+                t.pending += stake;
+                t.next_release = std::min(t.next_release, release_time);
+            });
         }
+    }
 
-        auto unstakes_itr = unstakes_idx.find(owner.value);
-        while (unstakes_itr != unstakes_idx.end() && unstakes_itr->account == owner) {
+    // Must be called before the unstake row is erased. next_release is left as is, at worst it is early and the next
+    // get_liquid walks the rows once to correct it.
+    void sub_unstake_total(name owner, name code, const dacdir::dac &dac, asset stake) {
+        init_unstake_total(owner, code, dac);
+
+        unstake_totals_table totals(code, dac.dac_id.value);
+        auto total = totals.require_find(owner.value, "ERR::UNSTAKE_TOTAL_NOT_FOUND::Unstake total not found");
+        if (total->pending == stake) {
+            totals.erase(total);
+        } else {
+            totals.modify(total, same_payer, [&](unstake_total &t) {
+                t.pending -= stake;
+            });
+        }
+    }
+
+    /**
+     * Erases released unstakes of an account, visiting at most UNSTAKE_COLLECT_BATCH rows. Until all of them are
+     * collected the remaining released stake is still counted as pending, so the liquid balance can be too low for a
+     * while but never too high. Calling claimunstkes again continues the collection.
+     */
+    void collect_released_unstakes(name owner, name code, const dacdir::dac &dac) {
+        unstake_totals_table totals(code, dac.dac_id.value);
+        auto                 total = totals.find(owner.value);
+        if (total == totals.end() || time_point_sec(current_time_point()) <= total->next_release) {
+            return;
+        }
+
+        unstakes_table unstakes(code, dac.dac_id.value);
+        auto           unstakes_idx = unstakes.get_index<"byaccount"_n>();
+        auto           unstakes_itr = unstakes_idx.find(owner.value);
+        auto           pending      = total->pending;
+        auto           next_release = time_point_sec::maximum();
+        auto           budget       = UNSTAKE_COLLECT_BATCH;
+        while (unstakes_itr != unstakes_idx.end() && unstakes_itr->account == owner && budget > 0) {
             if (unstakes_itr->released()) {
-                print("this is already released, erasing");
+                LOG_TRACE("this is already released, erasing");
                 // if this unstake is already released, it can be safely deleted
+                pending -= unstakes_itr->stake;
                 unstakes_itr = unstakes_idx.erase(unstakes_itr);
             } else {
-                print("NOT yet released");
-                canDeleteStakeTime = false;
-                // otherwise it still negatively impacts the liquid balance
-                liquid -= unstakes_itr->stake;
+                LOG_TRACE("NOT yet released");
+                next_release = std::min(next_release, unstakes_itr->release_time);
                 unstakes_itr++;
             }
+            budget--;
+        }
+        const auto complete = unstakes_itr == unstakes_idx.end() || unstakes_itr->account != owner;
+
+        if (complete && next_release == time_point_sec::maximum()) {
+            totals.erase(total);
+        } else {
+            totals.modify(total, same_payer, [&](unstake_total &t) {
+                t.pending = pending;
+                // When the walk was cut short the rows further on were not seen, keep next_release in the past so the
+                // next call carries on.
+                if (complete) {
+                    t.next_release = next_release;
+                }
+            });
+        }
+    }
+
+    asset get_liquid(name owner, name code, const dacdir::dac &dac) {
+        stakes_table stakes(code, dac.dac_id.value);
+
+        asset liquid = get_balance(owner, code, dac.symbol.get_symbol().code());
+
+        auto canDeleteStakeTime = true;
+
+        auto existing_stake = stakes.find(owner.value);
+        if (existing_stake != stakes.end()) {
+            liquid -= existing_stake->stake;
+            canDeleteStakeTime = false;
+        }
+
+        init_unstake_total(owner, code, dac);
+        collect_released_unstakes(owner, code, dac);
+
+        // Pending unstakes still negatively impact the liquid balance
+        unstake_totals_table totals(code, dac.dac_id.value);
+        auto                 total = totals.find(owner.value);
+        if (total != totals.end()) {
+            liquid -= total->pending;
+            canDeleteStakeTime = false;
         }
+
         if (canDeleteStakeTime) {
             staketimes_table staketimes(code, dac.dac_id.value);
 
@@ -210,6 +351,30 @@ namespace eosdac {
         return liquid;
     }
 
+    asset get_liquid(name owner, name code, symbol sym) {
+        // Hardcoding a precision of 4, it doesnt matter because the index ignores precision
+        return get_liquid(owner, code, dacdir::dac_for_symbol(extended_symbol{sym, code}));
+    }
+
+    /**
+     * Cheap probe for whether any of owner's balance can be locked by staking, i.e. whether get_liquid can return less
+     * than the balance. Lets hot paths such as transfer skip get_liquid for accounts that never staked.
+     */
+    bool has_stake_state(name owner, name code, const dacdir::dac &dac) {
+        const auto stakes = stakes_table{code, dac.dac_id.value};
+        if (stakes.find(owner.value) != stakes.end()) {
+            return true;
+        }
+        const auto totals = unstake_totals_table{code, dac.dac_id.value};
+        if (totals.find(owner.value) != totals.end()) {
+            return true;
+        }
+        // Unstakes from before the totals were tracked
+        const auto unstakes     = unstakes_table{code, dac.dac_id.value};
+        const auto unstakes_idx = unstakes.get_index<"byaccount"_n>();
+        return unstakes_idx.find(owner.value) != unstakes_idx.end();
+    }
+
     asset get_staked(name owner, name code, symbol sym) {
         // Hardcoding a precision of 4, it doesnt matter because the index ignores precision
         dacdir::dac dac = dacdir::dac_for_symbol(extended_symbol{sym, code});
@@ -226,26 +391,45 @@ namespace eosdac {
         return staked;
     }
 
-    static void assertValidMembers(const std::vector<name> &members, eosio::name dac_id) {
-        eosio::name member_terms_account;
+    static uint64_t latest_terms_version(const name member_terms_account, const name dac_id) {
+        auto current = terms_version_container{member_terms_account, dac_id.value};
+        if (current.exists()) {
+            return current.get().version;
+        }
 
-        member_terms_account =
-            dacdir::dac_for_id(dac_id).symbol.get_contract(); // Need this line without the temp block
-        regmembers reg_members(member_terms_account, dac_id.value);
-        memterms   memberterms(member_terms_account, dac_id.value);
-        auto       latest_member_terms = (--memberterms.end());
+        // Terms published before the version was tracked
+        const auto memberterms = memterms{member_terms_account, dac_id.value};
+        eosio::check(memberterms.begin() != memberterms.end(), "ERR::GENERAL_NO_MEMBER_TERMS::No member terms found.");
+        return (--memberterms.end())->version;
+    }
+
+    static void assertValidMembers(const std::vector<name> &members, const dacdir::dac &dac) {
+        if (members.empty()) {
+            return;
+        }
+        const auto member_terms_account = dac.symbol.get_contract();
+        regmembers reg_members(member_terms_account, dac.dac_id.value);
+        const auto latest_version = latest_terms_version(member_terms_account, dac.dac_id);
         for (const auto member : members) {
             const auto &regmem = reg_members.get(member.value,
                 fmt("ERR::GENERAL_REG_MEMBER_NOT_FOUND::Account %s is not registered with members.", member));
             eosio::check((regmem.agreedterms != 0),
                 "ERR::GENERAL_MEMBER_HAS_NOT_AGREED_TO_ANY_TERMS::Account has not agreed to any terms");
-            eosio::check(latest_member_terms->version == regmem.agreedterms,
+            eosio::check(latest_version == regmem.agreedterms,
                 "ERR::GENERAL_MEMBER_HAS_NOT_AGREED_TO_LATEST_TERMS::Agreed terms isn't the latest.");
         }
     }
 
-    static void assertValidMember(name member, eosio::name dac_id) {
+    static void assertValidMembers(const std::vector<name> &members, eosio::name dac_id) {
+        assertValidMembers(members, dacdir::dac_for_id(dac_id));
+    }
+
+    static void assertValidMember(name member, const dacdir::dac &dac) {
         auto members = std::vector{member};
-        assertValidMembers(members, dac_id);
+        assertValidMembers(members, dac);
+    }
+
+    static void assertValidMember(name member, eosio::name dac_id) {
+        assertValidMember(member, dacdir::dac_for_id(dac_id));
     }
 } // namespace eosdac
@@ -0,0 +1,57 @@
+#pragma once
+#include <eosio/print.hpp>
+
+/**
+ * Levelled diagnostic logging for the contracts.
+ *
+ * print() output only appears in action traces and node consoles, yet formatting it still costs CPU on every call.
+ * All macros below therefore expand to nothing, without evaluating their arguments, unless the build opts in:
+ *
+ * - `-DDEBUG` (the build-debug target) enables LOG_INFO and LOG_DEBUG
+ * - `-DTRACE_LOGGING` additionally enables LOG_TRACE, meant for per-row output inside loops
+ * - `-DDAC_LOG_LEVEL=<n>` overrides both
+ *
+ * LOG_*_F variants take the eosio::print_f format string with `%` placeholders.
+ */
+#define DAC_LOG_LEVEL_NONE 0
+#define DAC_LOG_LEVEL_INFO 1
+#define DAC_LOG_LEVEL_DEBUG 2
+#define DAC_LOG_LEVEL_TRACE 3
+
+#ifndef DAC_LOG_LEVEL
+#if defined(TRACE_LOGGING)
+#define DAC_LOG_LEVEL DAC_LOG_LEVEL_TRACE
+#elif defined(DEBUG)
+#define DAC_LOG_LEVEL DAC_LOG_LEVEL_DEBUG
+#else
+#define DAC_LOG_LEVEL DAC_LOG_LEVEL_NONE
+#endif
+#endif
+
+#define DAC_LOG_DISABLED(...)                                                                                          \
+    do {                                                                                                               \
+    } while (0)
+
+#if DAC_LOG_LEVEL >= DAC_LOG_LEVEL_INFO
+#define LOG_INFO(...) eosio::print(__VA_ARGS__)
+#define LOG_INFO_F(...) eosio::print_f(__VA_ARGS__)
+#else
+#define LOG_INFO(...) DAC_LOG_DISABLED()
+#define LOG_INFO_F(...) DAC_LOG_DISABLED()
+#endif
+
+#if DAC_LOG_LEVEL >= DAC_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) eosio::print(__VA_ARGS__)
+#define LOG_DEBUG_F(...) eosio::print_f(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) DAC_LOG_DISABLED()
+#define LOG_DEBUG_F(...) DAC_LOG_DISABLED()
+#endif
+
+#if DAC_LOG_LEVEL >= DAC_LOG_LEVEL_TRACE
+#define LOG_TRACE(...) eosio::print(__VA_ARGS__)
+#define LOG_TRACE_F(...) eosio::print_f(__VA_ARGS__)
+#else
+#define LOG_TRACE(...) DAC_LOG_DISABLED()
+#define LOG_TRACE_F(...) DAC_LOG_DISABLED()
+#endif
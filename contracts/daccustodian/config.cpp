@@ -222,6 +222,45 @@ ACTION daccustodian::setpaymax(const extended_asset &requested_pay_max, const na
     globals.set_requested_pay_max(requested_pay_max);
 }
 
+ACTION daccustodian::setperiodbat(const uint32_t &batch_size, const name &dac_id) {
+
+    if (!has_auth(get_self())) {
+        const dacdir::dac dacForScope = dacdir::dac_for_id(dac_id);
+        require_auth(dacForScope.owner);
+    }
+
+    check(batch_size > 0, "ERR::SETPERIODBAT_INVALID_VALUE::The period batch size must be greater than zero.");
+
+    auto globals = dacglobals{get_self(), dac_id};
+    globals.set_period_batch_size(batch_size);
+}
+
+ACTION daccustodian::setpayledger(const bool &enabled, const name &dac_id) {
+
+    if (!has_auth(get_self())) {
+        const dacdir::dac dacForScope = dacdir::dac_for_id(dac_id);
+        require_auth(dacForScope.owner);
+    }
+
+    auto globals = dacglobals{get_self(), dac_id};
+    if (enabled) {
+        globals.set_pay_ledger_mode(true);
+    } else {
+        globals.unset_pay_ledger_mode();
+    }
+}
+
+ACTION daccustodian::resetauths(const name &dac_id) {
+
+    if (!has_auth(get_self())) {
+        const dacdir::dac dacForScope = dacdir::dac_for_id(dac_id);
+        require_auth(dacForScope.owner);
+    }
+
+    auto globals = dacglobals{get_self(), dac_id};
+    globals.unset_auth_fingerprint();
+}
+
 ACTION daccustodian::settokensup(const uint64_t &token_supply_theshold, const name &dac_id) {
 
     if (!has_auth(get_self())) {
@@ -13,6 +13,7 @@ import {
   assertBalanceEqual,
   Asset,
   ContractDeployer,
+  UpdateAuth,
 } from 'lamington';
 const _ = require('lodash');
 import {
@@ -769,6 +770,88 @@ describe('Daccustodian', () => {
     });
   });
 
+  context('member terms version', async () => {
+    const dacId = 'termsverdac';
+    let earlyMember: Account;
+    let lateMember: Account;
+
+    before(async () => {
+      await shared.initDac(dacId, '0,TERMDAC', '1000000 TERMDAC');
+      await shared.updateconfig(dacId, '0 TERMDAC');
+      [earlyMember, lateMember] = await AccountManager.createAccounts(2);
+      await shared.dac_token_contract.memberreg(
+        earlyMember.name,
+        shared.configured_dac_memberterms,
+        dacId,
+        { from: earlyMember }
+      );
+    });
+    it('newmemterms should record the first version', async () => {
+      await assertRowsEqual(
+        shared.dac_token_contract.termsverTable({ scope: dacId }),
+        [{ version: 1 }]
+      );
+    });
+    it('newmemterms should record the next version', async () => {
+      await shared.dac_token_contract.newmemterms(
+        'https://example.com/constitution_v2.md',
+        'termsv2hash',
+        dacId,
+        { from: shared.auth_account }
+      );
+      await assertRowsEqual(
+        shared.dac_token_contract.termsverTable({ scope: dacId }),
+        [{ version: 2 }]
+      );
+    });
+    it('should reject a member of the previous terms', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.daccustodian_contract.nominatecane(
+          earlyMember.name,
+          '25.0000 EOS',
+          dacId,
+          { from: earlyMember }
+        ),
+        'ERR::GENERAL_MEMBER_HAS_NOT_AGREED_TO_LATEST_TERMS'
+      );
+    });
+    context('without the termsver singleton', async () => {
+      before(async () => {
+        await shared.dac_token_contract.tstrmtermsv(dacId);
+        await shared.dac_token_contract.memberreg(
+          lateMember.name,
+          'termsv2hash',
+          dacId,
+          { from: lateMember }
+        );
+      });
+      it('should have removed the singleton', async () => {
+        await assertRowCount(
+          shared.dac_token_contract.termsverTable({ scope: dacId }),
+          0
+        );
+      });
+      it('should still reject a member of the previous terms', async () => {
+        await assertEOSErrorIncludesMessage(
+          shared.daccustodian_contract.nominatecane(
+            earlyMember.name,
+            '25.0000 EOS',
+            dacId,
+            { from: earlyMember }
+          ),
+          'ERR::GENERAL_MEMBER_HAS_NOT_AGREED_TO_LATEST_TERMS'
+        );
+      });
+      it('should accept a member of the latest terms', async () => {
+        await shared.daccustodian_contract.nominatecane(
+          lateMember.name,
+          '25.0000 EOS',
+          dacId,
+          { from: lateMember }
+        );
+      });
+    });
+  });
   context('verified dac registering', async () => {
     context('With a staking enabled DAC', async () => {
       const dacId = 'veristakedac';
@@ -1317,6 +1400,54 @@ describe('Daccustodian', () => {
           chai.expect(actual).to.equal(30_000_000);
         });
       });
+      context('After swapping one candidate of an existing vote', async () => {
+        before(async () => {
+          await shared.daccustodian_contract.votecust(
+            newVoter.name,
+            [cands[0].name, cands[3].name],
+            dacId,
+            { from: newVoter }
+          );
+        });
+        it('should keep the vote power and voters of the unchanged candidate', async () => {
+          const res = await shared.daccustodian_contract.candidatesTable({
+            scope: dacId,
+            limit: 1,
+            lowerBound: cands[0].name,
+          });
+          chai.expect(res.rows[0]).to.include({
+            total_vote_power: 30_000_000,
+            number_voters: 3,
+          });
+        });
+        it('should move the vote from the removed to the added candidate', async () => {
+          const removed = await shared.daccustodian_contract.candidatesTable({
+            scope: dacId,
+            limit: 1,
+            lowerBound: cands[2].name,
+          });
+          chai.expect(removed.rows[0]).to.include({
+            total_vote_power: 20_000_000,
+            number_voters: 2,
+          });
+          const added = await shared.daccustodian_contract.candidatesTable({
+            scope: dacId,
+            limit: 1,
+            lowerBound: cands[3].name,
+          });
+          chai.expect(added.rows[0]).to.include({
+            total_vote_power: 10_000_000,
+            number_voters: 1,
+          });
+        });
+        it('state should not have changed the total_weight_of_votes', async () => {
+          const actual = await get_from_dacglobals(
+            dacId,
+            'total_weight_of_votes'
+          );
+          chai.expect(actual).to.equal(30_000_000);
+        });
+      });
       context('After removing additional vote', async () => {
         before(async () => {
           await shared.daccustodian_contract.votecust(
@@ -2292,6 +2423,400 @@ describe('Daccustodian', () => {
       );
     });
   });
+  context('paged new period', () => {
+    let dacId = 'pagedac';
+    let regMembers: Account[];
+    let candidates: Account[];
+    before(async () => {
+      await shared.initDac(dacId, '4,PAGEDAC', '1000000.0000 PAGEDAC');
+      await shared.updateconfig(dacId, '12.0000 PAGEDAC');
+      await shared.dac_token_contract.stakeconfig(
+        { enabled: true, min_stake_time: 1233, max_stake_time: 1500 },
+        '4,PAGEDAC',
+        { from: shared.auth_account }
+      );
+      regMembers = await shared.getRegMembers(dacId, '20000.0000 PAGEDAC');
+      candidates = await shared.getStakeObservedCandidates(
+        dacId,
+        '12.0000 PAGEDAC'
+      );
+      await shared.voteForCustodians(regMembers, candidates, dacId);
+      await shared.daccustodian_contract.setperiodbat(2, dacId, {
+        from: shared.auth_account,
+      });
+      await shared.daccustodian_contract.newperiod('pagedac', dacId, {
+        from: regMembers[0],
+      });
+      await sleep(4_000);
+    });
+    it('setperiodbat should reject a zero batch size', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.daccustodian_contract.setperiodbat(0, dacId, {
+          from: shared.auth_account,
+        }),
+        'ERR::SETPERIODBAT_INVALID_VALUE'
+      );
+    });
+    it('first call should only move part of the pending custodians', async () => {
+      await shared.daccustodian_contract.newperiod('pagedac 1', dacId, {
+        from: regMembers[0],
+      });
+      chai
+        .expect(await get_from_dacglobals(dacId, 'period_stage'))
+        .to.not.equal(undefined);
+      await assertRowCount(
+        shared.daccustodian_contract.pendingcustsTable({
+          scope: dacId,
+          limit: 12,
+        }),
+        3
+      );
+    });
+    it('resigning a custodian while the period is in progress should fail', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.daccustodian_contract.resigncust(candidates[0].name, dacId, {
+          from: candidates[0],
+        }),
+        'ERR::REMOVECUSTODIAN_PERIOD_IN_PROGRESS'
+      );
+    });
+    it('further calls should finish the period', async () => {
+      await shared.daccustodian_contract.newperiod('pagedac 2', dacId, {
+        from: regMembers[0],
+      });
+      await shared.daccustodian_contract.newperiod('pagedac 3', dacId, {
+        from: regMembers[0],
+      });
+      chai
+        .expect(await get_from_dacglobals(dacId, 'period_stage'))
+        .to.equal(undefined);
+      await assertRowCount(
+        shared.daccustodian_contract.pendingcustsTable({
+          scope: dacId,
+          limit: 12,
+        }),
+        0
+      );
+      await assertRowCount(
+        shared.daccustodian_contract.custodians1Table({
+          scope: dacId,
+          limit: 12,
+        }),
+        5
+      );
+    });
+    it('should publish the elected custodians to custset', async () => {
+      const custodians = await shared.daccustodian_contract.custodians1Table({
+        scope: dacId,
+        limit: 12,
+      });
+      const res = await shared.daccustodian_contract.custsetTable({
+        scope: dacId,
+      });
+      chai
+        .expect(res.rows[0].custodians)
+        .to.deep.equal(custodians.rows.map((row) => row.cust_name));
+      chai.expect(Number(res.rows[0].generation)).to.be.greaterThan(0);
+    });
+  });
+  context('paged mean pay', () => {
+    const dacId = 'pagedac';
+    let stored_mean: any;
+    const period_stage = () => get_from_dacglobals(dacId, 'period_stage');
+    before(async () => {
+      await sleep(6_000);
+      await shared.daccustodian_contract.newperiod('pagepay', dacId, {
+        from: somebody,
+      });
+      await sleep(4_000);
+    });
+    it('first batch should fix the mean pay for the stage', async () => {
+      await shared.daccustodian_contract.newperiod('pagepay 1', dacId, {
+        from: somebody,
+      });
+      chai.expect(await period_stage()).to.not.equal(undefined);
+      stored_mean = await get_from_dacglobals(dacId, 'period_mean_pay');
+      chai.expect(stored_mean).to.not.equal(undefined);
+      await assertRowCount(
+        shared.daccustodian_contract.pendingpayTable({
+          scope: dacId,
+          limit: 12,
+        }),
+        2
+      );
+    });
+    it('later batches should pay the same mean after the pay max changes', async () => {
+      await shared.daccustodian_contract.setpaymax(
+        { contract: 'eosio.token', quantity: '16.0000 EOS' },
+        dacId
+      );
+      for (let i = 2; (await period_stage()) !== undefined && i < 10; i++) {
+        await shared.daccustodian_contract.newperiod(`pagepay ${i}`, dacId, {
+          from: somebody,
+        });
+      }
+      chai.expect(await period_stage()).to.equal(undefined);
+      chai
+        .expect(await get_from_dacglobals(dacId, 'period_mean_pay'))
+        .to.equal(undefined);
+      const res = await shared.daccustodian_contract.pendingpayTable({
+        scope: dacId,
+        limit: 12,
+      });
+      chai.expect(res.rows.length).to.equal(5);
+      for (const row of res.rows) {
+        chai.expect(row.quantity).to.deep.equal(stored_mean);
+      }
+    });
+    after(async () => {
+      await shared.daccustodian_contract.setpaymax(
+        { contract: 'eosio.token', quantity: '30.0000 EOS' },
+        dacId
+      );
+    });
+  });
+  context('pay ledger mode', () => {
+    const dacId = 'pagedac';
+    let claimed: any;
+    let other: any;
+    const payRow = async (key: string) => {
+      const res = await shared.daccustodian_contract.pendingpayTable({
+        scope: dacId,
+        lowerBound: key,
+        upperBound: key,
+      });
+      return res.rows[0];
+    };
+    const payAmount = (row: any) => Number(row.quantity.quantity.split(' ')[0]);
+    before(async () => {
+      const res = await shared.daccustodian_contract.pendingpayTable({
+        scope: dacId,
+        limit: 12,
+      });
+      [claimed, other] = res.rows;
+    });
+    it('without self or owner auth, setpayledger should fail', async () => {
+      await assertMissingAuthority(
+        shared.daccustodian_contract.setpayledger(true, dacId, {
+          from: somebody,
+        })
+      );
+    });
+    it('setpayledger should enable ledger mode', async () => {
+      await shared.daccustodian_contract.setpayledger(true, dacId);
+      chai
+        .expect(await get_from_dacglobals(dacId, 'pay_ledger_mode'))
+        .to.equal(true);
+    });
+    it('claimpay should zero the row instead of erasing it', async () => {
+      await shared.daccustodian_contract.claimpay(claimed.key, dacId, {
+        auths: [{ actor: claimed.receiver, permission: 'active' }],
+      });
+      chai.expect(payAmount(await payRow(claimed.key))).to.equal(0);
+    });
+    it('a second claim should fail with nothing to claim', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.daccustodian_contract.claimpay(claimed.key, dacId, {
+          auths: [{ actor: claimed.receiver, permission: 'active' }],
+        }),
+        'ERR::CLAIMPAY_NOTHING_TO_CLAIM'
+      );
+    });
+    it('the next pay should be added to the zeroed row', async () => {
+      await sleep(6_000);
+      await shared.daccustodian_contract.newperiod('ledger', dacId, {
+        from: somebody,
+      });
+      await sleep(4_000);
+      let i = 1;
+      do {
+        await shared.daccustodian_contract.newperiod(`ledger ${i}`, dacId, {
+          from: somebody,
+        });
+        i++;
+      } while (
+        (await get_from_dacglobals(dacId, 'period_stage')) !== undefined &&
+        i < 10
+      );
+      const mean = payAmount(await payRow(other.key)) - payAmount(other);
+      chai.expect(mean).to.be.greaterThan(0);
+      chai.expect(payAmount(await payRow(claimed.key))).to.equal(mean);
+      const res = await shared.daccustodian_contract.pendingpayTable({
+        scope: dacId,
+        limit: 12,
+      });
+      chai
+        .expect(
+          res.rows.filter((row: any) => row.receiver == claimed.receiver)
+        )
+        .to.have.lengthOf(1);
+    });
+    after(async () => {
+      await shared.daccustodian_contract.setpayledger(false, dacId);
+    });
+  });
+  context('revalperm on a legacy candperms row', () => {
+    const dacId = 'pagedac';
+    let cand: string;
+    before(async () => {
+      const custodians = await shared.daccustodian_contract.custodians1Table({
+        scope: dacId,
+        limit: 12,
+      });
+      cand = custodians.rows[0].cust_name;
+      await shared.daccustodian_contract.tstlegperm(cand, 'legacyperm', dacId);
+    });
+    it('should start with a stored auth fingerprint', async () => {
+      chai
+        .expect(await get_from_dacglobals(dacId, 'auth_fingerprint'))
+        .to.not.equal(undefined);
+    });
+    it('should clear the auth fingerprint', async () => {
+      await shared.daccustodian_contract.revalperm(cand, dacId);
+      chai
+        .expect(await get_from_dacglobals(dacId, 'auth_fingerprint'))
+        .to.equal(undefined);
+    });
+    it('should cache the permission check', async () => {
+      const res = await shared.daccustodian_contract.candpermsTable({
+        scope: dacId,
+        lowerBound: cand,
+        upperBound: cand,
+      });
+      chai.expect(res.rows[0].permission_exists).to.equal(false);
+      chai.expect(res.rows[0].validated_at).to.not.equal(null);
+    });
+  });
+  context('custom permission deleted after setperm', () => {
+    const dacId = 'permdac';
+    let regMembers: Account[];
+    let cust: Account;
+    before(async () => {
+      await shared.initDac(dacId, '4,PERMDAC', '1000000.0000 PERMDAC');
+      await shared.updateconfig(dacId, '12.0000 PERMDAC');
+      await shared.dac_token_contract.stakeconfig(
+        { enabled: true, min_stake_time: 1233, max_stake_time: 1500 },
+        '4,PERMDAC',
+        { from: shared.auth_account }
+      );
+      regMembers = await shared.getRegMembers(dacId, '20000.0000 PERMDAC');
+      const candidates = await shared.getStakeObservedCandidates(
+        dacId,
+        '12.0000 PERMDAC'
+      );
+      await shared.voteForCustodians(regMembers, candidates, dacId);
+      await shared.daccustodian_contract.newperiod('permdac', dacId, {
+        from: regMembers[0],
+      });
+      await sleep(6_000);
+      await shared.daccustodian_contract.newperiod('permdac', dacId, {
+        from: regMembers[0],
+      });
+
+      const custodians = await shared.daccustodian_contract.custodians1Table({
+        scope: dacId,
+        limit: 12,
+      });
+      cust = candidates.find(
+        (c) => c.name == custodians.rows[0].cust_name
+      ) as Account;
+      await UpdateAuth.execUpdateAuth(
+        cust.active,
+        cust.name,
+        'custom',
+        'active',
+        UpdateAuth.AuthorityToSet.explicitAuthorities(
+          1,
+          [],
+          [{ key: cust.publicKey, weight: 1 }],
+          []
+        )
+      );
+      await shared.daccustodian_contract.setperm(cust.name, 'custom', dacId, {
+        from: cust,
+      });
+      await EOSManager.transact({
+        actions: [
+          {
+            account: 'eosio',
+            name: 'deleteauth',
+            authorization: [{ actor: cust.name, permission: 'active' }],
+            data: { account: cust.name, permission: 'custom' },
+          },
+        ],
+      });
+    });
+    it('revalperm should not need the candidate or contract auth', async () => {
+      await shared.daccustodian_contract.revalperm(cust.name, dacId, {
+        from: somebody,
+      });
+      const res = await shared.daccustodian_contract.candpermsTable({
+        scope: dacId,
+        lowerBound: cust.name,
+        upperBound: cust.name,
+      });
+      chai.expect(res.rows[0].permission_exists).to.equal(false);
+    });
+    it('newperiod should rebuild the authority with the active permission', async () => {
+      await sleep(6_000);
+      await shared.daccustodian_contract.newperiod('permdac 2', dacId, {
+        from: regMembers[0],
+      });
+      await sleep(4_000);
+      await shared.daccustodian_contract.newperiod('permdac 3', dacId, {
+        from: regMembers[0],
+      });
+      chai
+        .expect(await get_from_dacglobals(dacId, 'period_stage'))
+        .to.equal(undefined);
+      chai
+        .expect(await get_from_dacglobals(dacId, 'auth_fingerprint'))
+        .to.not.equal(undefined);
+    });
+  });
+  context('auth fingerprint', () => {
+    const dacId = 'permdac';
+    const runPeriod = async (message: string) => {
+      await sleep(6_000);
+      await shared.daccustodian_contract.newperiod(message, dacId, {
+        from: somebody,
+      });
+      await sleep(4_000);
+      return shared.daccustodian_contract.newperiod(`${message} run`, dacId, {
+        from: somebody,
+      });
+    };
+    it('without self or owner auth, resetauths should fail', async () => {
+      await assertMissingAuthority(
+        shared.daccustodian_contract.resetauths(dacId, { from: somebody })
+      );
+    });
+    it('an unchanged authority should not send updateauth', async () => {
+      const res: any = await runPeriod('fingerprint 1');
+      chai
+        .expect(inlineActionNames(res.processed.action_traces[0]))
+        .to.not.include('updateauth');
+    });
+    it('a threshold change should rebuild the authority', async () => {
+      await shared.daccustodian_contract.setdaogov(2, 5, 3, dacId);
+      const res: any = await runPeriod('fingerprint 2');
+      chai
+        .expect(inlineActionNames(res.processed.action_traces[0]))
+        .to.include('updateauth');
+    });
+    it('resetauths should force the next rebuild', async () => {
+      await shared.daccustodian_contract.resetauths(dacId, {
+        from: shared.auth_account,
+      });
+      chai
+        .expect(await get_from_dacglobals(dacId, 'auth_fingerprint'))
+        .to.equal(undefined);
+      const res: any = await runPeriod('fingerprint 3');
+      chai
+        .expect(inlineActionNames(res.processed.action_traces[0]))
+        .to.include('updateauth');
+    });
+  });
   context('resign custodian', () => {
     let dacId = 'resigndac';
     let regMembers: Account[];
@@ -2497,6 +3022,7 @@ describe('Daccustodian', () => {
             .expect(cand.candidate_name)
             .to.equal(electedCandidateToResign.name);
           chai.expect(cand.is_active).to.equal(0);
+          chai.expect(cand.rank).to.equal(0);
         });
       });
       context('for an unelected candidate', async () => {
@@ -3248,6 +3774,79 @@ describe('Daccustodian', () => {
         );
       });
     });
+    context('rerankcands', async () => {
+      const dacId = 'nperidac';
+      let table_before: any[];
+      before(async () => {
+        const res = await shared.daccustodian_contract.candidatesTable({
+          scope: dacId,
+          limit: 100,
+        });
+        table_before = res.rows;
+        chai.expect(table_before.length).to.be.greaterThan(2);
+        await shared.daccustodian_contract.clearrank(dacId);
+      });
+      it('without self auth, should throw authentication error', async () => {
+        await assertMissingAuthority(
+          shared.daccustodian_contract.rerankcands(dacId, '', 2, {
+            from: somebody,
+          })
+        );
+      });
+      it('should reject a zero batch size', async () => {
+        await assertEOSErrorIncludesMessage(
+          shared.daccustodian_contract.rerankcands(dacId, '', 0),
+          'ERR::RERANKCANDS_INVALID_BATCH_SIZE'
+        );
+      });
+      it('should only rerank one batch', async () => {
+        await shared.daccustodian_contract.rerankcands(dacId, '', 2);
+        const res = await shared.daccustodian_contract.candidatesTable({
+          scope: dacId,
+          limit: 100,
+        });
+        chai
+          .expect(res.rows.slice(0, 2))
+          .to.deep.equal(table_before.slice(0, 2));
+        for (const row of res.rows.slice(2)) {
+          chai.expect(row.rank).to.equal(314159);
+        }
+      });
+      it('should resume from the cursor', async () => {
+        await shared.daccustodian_contract.rerankcands(
+          dacId,
+          table_before[2].candidate_name,
+          100
+        );
+        await assertRowsEqual(
+          shared.daccustodian_contract.candidatesTable({
+            scope: dacId,
+            limit: 100,
+          }),
+          table_before
+        );
+      });
+    });
+    context('checkrank', async () => {
+      it('integer rank should match the double implementation', async () => {
+        const timestamps = [
+          0, 1, 1234567, 1700000003, 1760000017, 1893456001, 2147483647,
+        ];
+        const samples = [];
+        for (let k = 0; k <= 44; k++) {
+          for (const offset of [-1, 0, 1]) {
+            const vote_power = 2 ** k + offset;
+            if (vote_power >= 0) {
+              samples.push({
+                first: vote_power,
+                second: timestamps[samples.length % timestamps.length],
+              });
+            }
+          }
+        }
+        await shared.daccustodian_contract.checkrank(samples);
+      });
+    });
     context('setprpbudget', async () => {
       it('without self auth, should throw authentication error', async () => {
         await assertMissingAuthority(
@@ -3926,6 +4525,15 @@ async function get_from_dacglobals(
   }
 }
 
+// Names of every inline action sent below the given action trace.
+function inlineActionNames(trace: any): string[] {
+  let names: string[] = [];
+  for (const inline of trace.inline_traces || []) {
+    names = names.concat([inline.act.name], inlineActionNames(inline));
+  }
+  return names;
+}
+
 function now() {
   return dayjs.utc().toDate();
 }
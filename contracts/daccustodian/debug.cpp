@@ -14,12 +14,12 @@ void daccustodian::collectvotes(const name &dac_id, name from, name to) {
 
     votes_table votes_cast_by_members(_self, dac_id.value);
     auto        vote_ittr = votes_cast_by_members.lower_bound(from.value);
+    auto        ctx       = dac_context{get_self(), dac_id};
 
     do {
-        update_number_of_votes({}, vote_ittr->candidates, dac_id);
-        const auto [vote_weight, vote_weight_quorum] = get_vote_weight(vote_ittr->voter, dac_id);
+        const auto [vote_weight, vote_weight_quorum] = get_vote_weight(vote_ittr->voter, ctx);
         modifyVoteWeights({vote_ittr->voter, vote_weight, vote_weight_quorum}, {}, {}, vote_ittr->candidates,
-            vote_ittr->vote_time_stamp, dac_id, true);
+            vote_ittr->vote_time_stamp, ctx, true);
         vote_ittr++;
     } while (vote_ittr != votes_cast_by_members.end() && vote_ittr->voter != to);
 }
@@ -80,6 +80,7 @@ void daccustodian::clearcusts(const name &dac_id) {
     while (cust != custodians.end()) {
         cust = custodians.erase(cust);
     }
+    publishCustodianSet(dac_id);
 }
 
 void daccustodian::maintenance(const bool maintenance) {
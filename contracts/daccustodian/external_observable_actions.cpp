@@ -3,8 +3,8 @@
 using namespace eosdac;
 
 ACTION daccustodian::balanceobsv(const vector<account_balance_delta> &account_balance_deltas, const name &dac_id) {
-    auto                         dac       = dacdir::dac_for_id(dac_id);
-    auto                         dacSymbol = dac.symbol.get_symbol();
+    auto                         ctx       = dac_context{get_self(), dac_id};
+    auto                         dacSymbol = ctx.get_dac().symbol.get_symbol();
     vector<account_weight_delta> weightDeltas;
     for (account_balance_delta balanceDelta : account_balance_deltas) {
         check(dacSymbol == balanceDelta.balance_delta.symbol,
@@ -13,12 +13,17 @@ ACTION daccustodian::balanceobsv(const vector<account_balance_delta> &account_ba
             {balanceDelta.account, balanceDelta.balance_delta.amount, balanceDelta.balance_delta.amount});
     }
 
-    weightobsv(weightDeltas, dac_id);
+    observeWeights(weightDeltas, ctx);
 }
 
 ACTION daccustodian::weightobsv(const vector<account_weight_delta> &account_weight_deltas, const name &dac_id) {
-    auto dac            = dacdir::dac_for_id(dac_id);
-    auto token_contract = dac.symbol.get_contract();
+    auto ctx = dac_context{get_self(), dac_id};
+    observeWeights(account_weight_deltas, ctx);
+}
+
+void daccustodian::observeWeights(const vector<account_weight_delta> &account_weight_deltas, dac_context &ctx) {
+    const auto &dac            = ctx.get_dac();
+    auto        token_contract = dac.symbol.get_contract();
 
     check(!maintenance_mode(), "Maintenance mode. Please try again in a few minutes");
 
@@ -27,24 +32,107 @@ ACTION daccustodian::weightobsv(const vector<account_weight_delta> &account_weig
     check(has_auth(token_contract) || (router_account && has_auth(*router_account)),
         "Must have auth of token or router contract to call weightobsv");
 
-    votes_table votes_cast_by_members(get_self(), dac_id.value);
+    votes_table votes_cast_by_members(get_self(), ctx.dac_id.value);
+
+    // Fold the whole batch in memory first so that each candidate, proxy and the globals are written once, no matter
+    // how many of the voters share them. The negative deltas are counted so that the clamp in applyVoteWeight keeps
+    // the tolerance it had when every delta was applied on its own.
+    auto candidate_deltas                 = std::map<name, candidate_weight_delta>{};
+    auto proxy_deltas                     = std::map<name, candidate_weight_delta>{};
+    auto total_weight_of_votes            = S{int64_t{}};
+    auto total_stake_time_weight_of_votes = S{int64_t{}};
+
+    const auto add_to_candidates = [&](const vector<name> &candidates, const int64_t weight, const int128_t weight_time,
+                                       const uint32_t negative_deltas) {
+        for (const auto &cand : candidates) {
+            auto &delta           = candidate_deltas[cand];
+            delta.weight          = S{delta.weight} + S{weight};
+            delta.weight_time     = S{delta.weight_time} + S{weight_time};
+            delta.negative_deltas = S{delta.negative_deltas} + S{negative_deltas};
+        }
+    };
 
-    for (account_weight_delta awd : account_weight_deltas) {
+    for (const account_weight_delta &awd : account_weight_deltas) {
         auto existingVote = votes_cast_by_members.find(awd.account.value);
-        if (existingVote != votes_cast_by_members.end()) {
-            if (existingVote->proxy.value != 0) {
-                modifyProxiesWeight(awd.weight_delta, name{}, existingVote->proxy, dac_id, false);
-            } else {
-                modifyVoteWeights(awd, {}, existingVote->vote_time_stamp, existingVote->candidates,
-                    existingVote->vote_time_stamp, dac_id, false);
-            }
+        if (existingVote == votes_cast_by_members.end() || awd.weight_delta == 0) {
+            continue;
+        }
+        const auto negative_deltas = awd.weight_delta < 0 ? uint32_t{1} : uint32_t{0};
+        if (existingVote->proxy.value != 0) {
+            auto &delta           = proxy_deltas[existingVote->proxy];
+            delta.weight          = S{delta.weight} + S{awd.weight_delta};
+            delta.negative_deltas = S{delta.negative_deltas} + S{negative_deltas};
+        } else if (!existingVote->candidates.empty()) {
+            total_weight_of_votes += S{awd.weight_delta_quorum};
+            total_stake_time_weight_of_votes += S{awd.weight_delta};
+
+            add_to_candidates(existingVote->candidates, awd.weight_delta,
+                vote_weight_time(awd.weight_delta, existingVote->vote_time_stamp), negative_deltas);
+        }
+    }
+
+    // A proxy passes its weight on to the candidates it voted for at the current time, as modifyProxiesWeight does, so
+    // fold that into the candidate deltas too rather than writing those candidates a second time.
+    auto proxies = proxies_table{get_self(), ctx.dac_id.value};
+    for (const auto &[proxy_name, delta] : proxy_deltas) {
+        auto proxyRow = proxies.find(proxy_name.value);
+        if (delta.weight == 0 || proxyRow == proxies.end()) {
+            continue;
+        }
+        proxies.modify(proxyRow, same_payer, [&](proxy &p) {
+            p.total_weight += delta.weight;
+        });
+
+        auto proxyVote = votes_cast_by_members.find(proxy_name.value);
+        if (proxyVote != votes_cast_by_members.end() && !proxyVote->candidates.empty()) {
+            total_weight_of_votes += S{delta.weight};
+            total_stake_time_weight_of_votes += S{delta.weight};
+
+            add_to_candidates(
+                proxyVote->candidates, delta.weight, vote_weight_time(delta.weight, now()), delta.negative_deltas);
         }
     }
+
+    if (total_weight_of_votes != int64_t{} || total_stake_time_weight_of_votes != int64_t{}) {
+        auto &globals = ctx.get_globals();
+        globals.set_total_weight_of_votes(S{globals.get_total_weight_of_votes()} + total_weight_of_votes);
+        globals.set_total_votes_on_candidates(
+            S{globals.get_total_votes_on_candidates()} + total_stake_time_weight_of_votes);
+    }
+
+    auto registered_candidates = candidates_table{get_self(), ctx.dac_id.value};
+    applyCandidateWeightDeltas(registered_candidates, candidate_deltas);
 }
 
 ACTION daccustodian::stakeobsv(const vector<account_stake_delta> &account_stake_deltas, const name &dac_id) {
-    auto dac            = dacdir::dac_for_id(dac_id);
-    auto token_contract = dac.symbol.get_contract();
+    auto ctx = dac_context{get_self(), dac_id};
+    observeStakes(account_stake_deltas, ctx);
+}
+
+/**
+ * Combined form of stakeobsv and weightobsv sent by the vote weight contract, so a stake change costs one inline
+ * action instead of two and the dac is only resolved once.
+ */
+ACTION daccustodian::stakewtobsv(
+    const vector<account_stake_weight_delta> &account_stake_weight_deltas, const name &dac_id) {
+    auto ctx           = dac_context{get_self(), dac_id};
+    auto stake_deltas  = vector<account_stake_delta>{};
+    auto weight_deltas = vector<account_weight_delta>{};
+    stake_deltas.reserve(account_stake_weight_deltas.size());
+    weight_deltas.reserve(account_stake_weight_deltas.size());
+
+    for (const auto &aswd : account_stake_weight_deltas) {
+        stake_deltas.push_back({aswd.account, aswd.stake_delta, aswd.unstake_delay});
+        weight_deltas.push_back({aswd.account, aswd.weight_delta, aswd.weight_delta_quorum});
+    }
+
+    observeStakes(stake_deltas, ctx);
+    observeWeights(weight_deltas, ctx);
+}
+
+void daccustodian::observeStakes(const vector<account_stake_delta> &account_stake_deltas, dac_context &ctx) {
+    const auto &dac            = ctx.get_dac();
+    auto        token_contract = dac.symbol.get_contract();
 
     const auto router_account = dac.account_for_type_maybe(dacdir::VOTE_WEIGHT);
 
@@ -64,7 +152,7 @@ ACTION daccustodian::stakeobsv(const vector<account_stake_delta> &account_stake_
 
     for (const auto &[account, net_stake_asset] : accounts_to_stake_amounts) {
         if (net_stake_asset.amount < 0) { // unstaking
-            validateUnstakeAmount(get_self(), account, -net_stake_asset, dac_id);
+            validateUnstakeAmount(get_self(), account, -net_stake_asset, ctx.dac_id);
         }
     }
 }
@@ -1,57 +1,71 @@
 using namespace eosdac;
 
-void daccustodian::distributeMeanPay(name dac_id) {
-    custodians_table  custodians(get_self(), dac_id.value);
-    pending_pay_table pending_pay(get_self(), dac_id.value);
-    const auto        globals = dacglobals{get_self(), dac_id};
-    name              owner   = dacdir::dac_for_id(dac_id).owner;
-
-    // Find the mean pay using a temporary vector to hold the requestedpay amounts.
-    extended_asset total = globals.get_requested_pay_max() - globals.get_requested_pay_max();
-    int64_t        count = 0;
-    for (auto cust : custodians) {
-        if (total.get_extended_symbol().get_symbol() == cust.requestedpay.symbol) {
-            if (cust.requestedpay.amount <= globals.get_requested_pay_max().quantity.amount) {
-                total += extended_asset(cust.requestedpay, total.contract);
+bool daccustodian::distributeMeanPay(dac_context &ctx, uint32_t &budget) {
+    custodians_table  custodians(get_self(), ctx.dac_id.value);
+    pending_pay_table pending_pay(get_self(), ctx.dac_id.value);
+    auto             &globals = ctx.get_globals();
+    name              owner   = ctx.get_dac().owner;
+
+    const auto cursor = globals.maybe_get_period_cursor().value_or(0);
+
+    // The mean is worked out once when the stage starts and reused by the later batches, so every custodian is paid
+    // the same amount even if the pay limit changes between newperiod calls.
+    auto stored_mean = globals.maybe_get_period_mean_pay();
+    if (!stored_mean) {
+        const auto     pay_max = globals.get_requested_pay_max();
+        extended_asset total   = pay_max - pay_max;
+        int64_t        count   = 0;
+        for (const auto &cust : custodians) {
+            if (total.get_extended_symbol().get_symbol() == cust.requestedpay.symbol) {
+                if (cust.requestedpay.amount <= pay_max.quantity.amount) {
+                    total += extended_asset(cust.requestedpay, total.contract);
+                }
+                count += 1;
             }
-            count += 1;
         }
+        stored_mean = extended_asset(count == 0 ? total.quantity : total.quantity / count, total.contract);
+        globals.set_period_mean_pay(*stored_mean);
     }
+    const auto mean = *stored_mean;
+
+    if (mean.quantity.amount > 0) {
+        // Collect the receivers this call has budget for, keyed by their receiversym index key.
+        auto receivers = vector<std::pair<checksum256, name>>{};
+        auto cust_itr  = custodians.lower_bound(cursor);
+        while (cust_itr != custodians.end() && receivers.size() < budget) {
+            receivers.emplace_back(pay::getIndex(cust_itr->cust_name, mean.get_extended_symbol()), cust_itr->cust_name);
+            cust_itr++;
+        }
+        budget -= static_cast<uint32_t>(receivers.size());
 
-    print("count during mean pay: ", count, " total: ", total);
-
-    asset meanAsset = count == 0 ? total.quantity : total.quantity / count;
-
-    print("mean asset for pay: ", meanAsset);
-
-    auto pendingPayReceiverSymbolIndex = pending_pay.get_index<"receiversym"_n>();
-
-    if (meanAsset.amount > 0) {
-        for (auto cust : custodians) {
-            print("\nLooping through custodians : ", cust.cust_name);
-
-            checksum256 idx = pay::getIndex(cust.cust_name, total.get_extended_symbol());
-            print("\ncreated a joint index : ", idx);
+        // Visit the receiversym index in key order rather than in custodian order.
+        std::sort(receivers.begin(), receivers.end());
+        auto pendingPayReceiverSymbolIndex = pending_pay.get_index<"receiversym"_n>();
+        for (const auto &[idx, receiver] : receivers) {
             auto itrr = pendingPayReceiverSymbolIndex.find(idx);
-            if (itrr != pendingPayReceiverSymbolIndex.end() && itrr->receiver == cust.cust_name &&
-                itrr->quantity.get_extended_symbol() == total.get_extended_symbol()) {
+            if (itrr != pendingPayReceiverSymbolIndex.end() && itrr->receiver == receiver &&
+                itrr->quantity.get_extended_symbol() == mean.get_extended_symbol()) {
                 pendingPayReceiverSymbolIndex.modify(itrr, same_payer, [&](pay &p) {
-                    print("\nAdding to existing amount with : ", extended_asset(meanAsset, total.contract));
-                    p.quantity += extended_asset(meanAsset, total.contract);
+                    p.quantity += mean;
                 });
             } else {
-                print("\n Creating pending pay amount with : ", extended_asset(meanAsset, total.contract));
-
                 pending_pay.emplace(owner, [&](pay &p) {
                     p.key      = pending_pay.available_primary_key();
-                    p.receiver = cust.cust_name;
-                    p.quantity = extended_asset(meanAsset, total.contract);
+                    p.receiver = receiver;
+                    p.quantity = mean;
                 });
             }
         }
+
+        if (cust_itr != custodians.end()) {
+            globals.set_period_cursor(cust_itr->cust_name.value);
+            return false;
+        }
     }
 
-    print("distribute mean pay");
+    globals.unset_period_mean_pay();
+    globals.unset_period_cursor();
+    return true;
 }
 
 void daccustodian::assertPeriodTime(const dacglobals &globals) {
@@ -75,13 +89,13 @@ bool daccustodian::periodIsPending(name dac_id) {
     return pending_custs.begin() != pending_custs.end();
 }
 
-void daccustodian::prepareCustodians(name dac_id) {
+void daccustodian::prepareCustodians(dac_context &ctx) {
     // Configure custodians for the next period.
-    pending_custodians_table pending_custs(get_self(), dac_id.value);
+    pending_custodians_table pending_custs(get_self(), ctx.dac_id.value);
 
-    candidates_table registered_candidates(get_self(), dac_id.value);
-    const auto       globals      = dacglobals{get_self(), dac_id};
-    name             auth_account = dacdir::dac_for_id(dac_id).owner;
+    candidates_table registered_candidates(get_self(), ctx.dac_id.value);
+    const auto      &globals      = ctx.get_globals();
+    name             auth_account = ctx.get_dac().owner;
     auto             byvotes      = registered_candidates.get_index<"bydecayed"_n>();
 
     const auto electcount = S{globals.get_numelected()};
@@ -93,7 +107,8 @@ void daccustodian::prepareCustodians(name dac_id) {
         check(cand_itr != byvotes.end() && cand_itr->total_vote_power > 0,
             "ERR::NEWPERIOD_NOT_ENOUGH_CANDIDATES::There are not enough eligible candidates to run new period without causing potential lock out permission structures for this DAC.");
 
-        // If the candidate is inactive or is already a pending custodian skip to the next one.
+        // Inactive candidates are ranked zero and sort after every candidate with votes, so this only skips rows that
+        // have not had their rank refreshed since being disabled (see rerankcands).
         if (!cand_itr->is_active) {
             cand_itr++;
         } else {
@@ -112,54 +127,78 @@ void daccustodian::prepareCustodians(name dac_id) {
     }
 }
 
-void daccustodian::allocateCustodians(name dac_id) {
-    pending_custodians_table pending_custs(get_self(), dac_id.value);
-    custodians_table         custodians(get_self(), dac_id.value);
+bool daccustodian::retireCustodians(dac_context &ctx, uint32_t &budget) {
+    pending_custodians_table pending_custs(get_self(), ctx.dac_id.value);
+    custodians_table         custodians(get_self(), ctx.dac_id.value);
+    auto                    &globals = ctx.get_globals();
 
-    if (pending_custs.begin() == pending_custs.end()) {
-        return; // SHOULD NOT HAPPEN
-    }
+    // Only erase the custodians that were not re-elected. Retained custodians are updated in place by
+    // allocateCustodians.
+    auto cust_itr = custodians.lower_bound(globals.maybe_get_period_cursor().value_or(0));
+    while (cust_itr != custodians.end()) {
+        if (budget == 0) {
+            globals.set_period_cursor(cust_itr->cust_name.value);
+            return false;
+        }
+        budget--;
 
-    // Configure custodians for the next period.
+        if (pending_custs.find(cust_itr->cust_name.value) == pending_custs.end()) {
+            cust_itr = custodians.erase(cust_itr);
+        } else {
+            cust_itr++;
+        }
+    }
 
-    // candidates_table registered_candidates(get_self(), dac_id.value);
-    const auto globals      = dacglobals{get_self(), dac_id};
-    name       auth_account = dacdir::dac_for_id(dac_id).owner;
+    globals.unset_period_cursor();
+    return true;
+}
 
-    auto newCustodianCount = S{uint8_t{0}};
+bool daccustodian::allocateCustodians(dac_context &ctx, uint32_t &budget) {
+    pending_custodians_table pending_custs(get_self(), ctx.dac_id.value);
+    custodians_table         custodians(get_self(), ctx.dac_id.value);
 
-    // Find how many new custodians do not exist in the current custodians.
-    for (auto pending_itr = pending_custs.begin(); pending_itr != pending_custs.end(); pending_itr++) {
-        if (custodians.find(pending_itr->cust_name.value) == custodians.end()) {
-            newCustodianCount++;
-        }
-    }
+    auto &globals      = ctx.get_globals();
+    name  auth_account = ctx.get_dac().owner;
 
-    // Empty the custodians table to get a full set of new custodians based on the current votes.
-    auto cust_itr = custodians.begin();
-    while (cust_itr != custodians.end()) {
-        cust_itr = custodians.erase(cust_itr);
-    }
+    // Carried over in the globals when moving the pending custodians is split across several calls.
+    auto newCustodianCount = S{globals.maybe_get_period_new_custodians().value_or(0)};
 
-    // Move pending custodians into custodians1
+    // Move pending custodians into custodians1, emplacing only the ones that are new this period.
     auto pending_cust_itr = pending_custs.begin();
     while (pending_cust_itr != pending_custs.end()) {
-        custodians.emplace(auth_account, [&](custodian &c) {
+        if (budget == 0) {
+            globals.set_period_new_custodians(newCustodianCount);
+            return false;
+        }
+        budget--;
+
+        const auto copy_pending = [&](custodian &c) {
             c.cust_name           = pending_cust_itr->cust_name;
             c.requestedpay        = pending_cust_itr->requestedpay;
             c.total_vote_power    = pending_cust_itr->total_vote_power;
             c.rank                = pending_cust_itr->rank;
             c.number_voters       = pending_cust_itr->number_voters;
             c.avg_vote_time_stamp = pending_cust_itr->avg_vote_time_stamp;
-        });
+        };
+
+        const auto existing = custodians.find(pending_cust_itr->cust_name.value);
+        if (existing == custodians.end()) {
+            newCustodianCount++;
+            custodians.emplace(auth_account, copy_pending);
+        } else {
+            custodians.modify(existing, same_payer, copy_pending);
+        }
         pending_cust_itr = pending_custs.erase(pending_cust_itr);
     }
+    globals.unset_period_new_custodians();
+    publishCustodianSet(ctx.dac_id);
 
     if (newCustodianCount >= globals.get_auth_threshold_high()) {
         action(permission_level{DACDIRECTORY_CONTRACT, "govmanage"_n}, DACDIRECTORY_CONTRACT, "hdlegovchg"_n,
-            std::make_tuple(dac_id))
+            std::make_tuple(ctx.dac_id))
             .send();
     }
+    return true;
 }
 
 vector<eosiosystem::permission_level_weight> daccustodian::get_perm_level_weights(
@@ -195,8 +234,8 @@ void daccustodian::add_auth_to_account(const name &accountToChange, const uint8_
 }
 
 void daccustodian::add_all_auths(const name            &accountToChange,
-    const vector<eosiosystem::permission_level_weight> &weights, const name &dac_id, const bool msig) {
-    const auto globals = dacglobals{get_self(), dac_id};
+    const vector<eosiosystem::permission_level_weight> &weights, dac_context &ctx, const bool msig) {
+    const auto &globals = ctx.get_globals();
 
     add_auth_to_account(accountToChange, globals.get_auth_threshold_high(), HIGH_PERMISSION, "active"_n, weights, msig);
 
@@ -209,15 +248,61 @@ void daccustodian::add_all_auths(const name            &accountToChange,
     add_auth_to_account(accountToChange, 1, ONE_PERMISSION, LOW_PERMISSION, weights, msig);
 }
 
-void daccustodian::setMsigAuths(name dac_id) {
-    const auto custodians      = custodians_table{get_self(), dac_id.value};
-    const auto dac             = dacdir::dac_for_id(dac_id);
-    const auto msigowned_opt   = dac.account_for_type_maybe(dacdir::MSIGOWNED);
-    const auto is_msig         = msigowned_opt.has_value();
-    const auto accountToChange = msigowned_opt.value_or(dac.owner);
+void daccustodian::setMsigAuths(dac_context &ctx) {
+    const auto  custodians      = custodians_table{get_self(), ctx.dac_id.value};
+    const auto &dac             = ctx.get_dac();
+    const auto  msigowned_opt   = dac.account_for_type_maybe(dacdir::MSIGOWNED);
+    const auto  is_msig         = msigowned_opt.has_value();
+    const auto  accountToChange = msigowned_opt.value_or(dac.owner);
+
+    // Skip the updateauths and the per-custodian permission checks when the authority would not change.
+    auto      &globals     = ctx.get_globals();
+    const auto fingerprint = auth_fingerprint(custodians, accountToChange, is_msig, ctx);
+    if (globals.maybe_get_auth_fingerprint() == fingerprint) {
+        return;
+    }
+
+    auto weights = get_perm_level_weights(custodians, ctx.dac_id);
+    add_all_auths(accountToChange, weights, ctx, is_msig);
+    globals.set_auth_fingerprint(fingerprint);
+}
+
+// Copies the names in custodians1 (already sorted, being the primary key) into the custset singleton.
+void daccustodian::publishCustodianSet(const name &dac_id) {
+    auto       published  = custodian_set_container{get_self(), dac_id.value};
+    auto       set        = published.get_or_default();
+    const auto custodians = custodians_table{get_self(), dac_id.value};
 
-    auto weights = get_perm_level_weights(custodians, dac_id);
-    add_all_auths(accountToChange, weights, dac_id, is_msig);
+    set.generation = S{set.generation} + S{uint64_t{1}};
+    set.custodians.clear();
+    for (const auto &cust : custodians) {
+        set.custodians.push_back(cust.cust_name);
+    }
+    published.set(set, get_self());
+}
+
+/**
+ * Compact hash of everything the authority built by setMsigAuths depends on: the account being changed, whether the
+ * msig contract is added, the thresholds and the custodians (in primary key order) with the permission that
+ * getCandidatePermission resolves from the cached check. Changes made outside this contract are not part of it, use
+ * resetauths to force the next rebuild.
+ */
+uint64_t daccustodian::auth_fingerprint(
+    const custodians_table &custodians, const name &accountToChange, const bool msig, dac_context &ctx) {
+    const auto &globals    = ctx.get_globals();
+    const auto  cand_perms = candperms_table{get_self(), ctx.dac_id.value};
+
+    auto levels = vector<permission_level>{};
+    for (const auto &cust : custodians) {
+        const auto perm = cand_perms.find(cust.cust_name.value);
+        const auto validated =
+            perm != cand_perms.end() && (!perm->permission_exists.has_value() || perm->permission_exists.value());
+        levels.emplace_back(cust.cust_name, validated ? perm->permission : "active"_n);
+    }
+
+    const auto packed = pack(std::make_tuple(accountToChange, msig, globals.get_auth_threshold_high(),
+        globals.get_auth_threshold_mid(), globals.get_auth_threshold_low(), levels));
+    return static_cast<uint64_t>(sha256(packed.data(), packed.size()).get_array()[0]);
 }
 
 asset balance_for_type(const dacdir::dac &dac, const dacdir::account_type type) {
@@ -332,66 +417,109 @@ ACTION daccustodian::newperiod(const string &message, const name &dac_id) {
 
 ACTION daccustodian::runnewperiod(const string &message, const name &dac_id) {
     /* This is a housekeeping method, it can be called by anyone by design */
-    auto globals = dacglobals{get_self(), dac_id};
+    auto  ctx     = dac_context{get_self(), dac_id};
+    auto &globals = ctx.get_globals();
 
-    dacdir::dac found_dac          = dacdir::dac_for_id(dac_id);
+    const auto &found_dac          = ctx.get_dac();
     const auto  activation_account = found_dac.account_for_type_maybe(dacdir::ACTIVATION);
 
     if (activation_account) {
         require_auth(*activation_account);
+    }
 
-        print("\n\nSending notification to ", *activation_account, "::assertunlock");
+    // A period that is already being finished skips the checks below and carries on from the stage it stopped at.
+    if (globals.maybe_get_period_stage().value_or(PERIOD_STAGE_IDLE) == PERIOD_STAGE_IDLE) {
+        if (activation_account) {
+            LOG_DEBUG("\n\nSending notification to ", *activation_account, "::assertunlock");
 
-        action(permission_level{*activation_account, "notify"_n}, *activation_account, "assertunlock"_n,
-            std::make_tuple(dac_id))
-            .send();
-    } else {
-        // Get the token supply of the lockup asset token (eg. EOSDAC)
-        auto statsTable = stats(found_dac.symbol.get_contract(), found_dac.symbol.get_symbol().code().raw());
-        auto tokenStats = statsTable.begin();
-        check(tokenStats != statsTable.end(), "ERR::STATS_NOT_FOUND::Stats table not found");
-        print("\n\nstats: ", tokenStats->supply, " contract: ", found_dac.symbol.get_contract(),
-            " symbol: ", found_dac.symbol.get_symbol());
-
-        uint64_t token_current_supply = tokenStats->supply.amount;
-
-        auto         tokenStakeConfig = stake_config::get_current_configs(found_dac.symbol.get_contract(), dac_id);
-        const double percent_of_current_voter_engagement =
-            S{globals.get_total_weight_of_votes()}.to<double>() / S{token_current_supply}.to<double>() * S{100.0};
-
-        check(token_current_supply > globals.get_token_supply_theshold(),
-            "ERR::NEWPERIOD_TOKEN_SUPPLY_TOO_LOW::Token Supply %s is insufficient to execute newperiod (%s required).",
-            token_current_supply, globals.get_token_supply_theshold());
-
-        check(globals.get_met_initial_votes_threshold() == true ||
-                  percent_of_current_voter_engagement > globals.get_initial_vote_quorum_percent(),
-            "ERR::NEWPERIOD_VOTER_ENGAGEMENT_LOW_ACTIVATE::Voter engagement %s is insufficient to activate the DAC (%s required) token_current_supply: %s total_weight_of_votes: %s.",
-            percent_of_current_voter_engagement, globals.get_initial_vote_quorum_percent(), token_current_supply,
-            globals.get_total_weight_of_votes());
-
-        check(percent_of_current_voter_engagement > globals.get_vote_quorum_percent(),
-            "ERR::NEWPERIOD_VOTER_ENGAGEMENT_LOW_PROCESS::Voter engagement is insufficient to process a new period");
-    }
-    globals.set_met_initial_votes_threshold(true);
+            action(permission_level{*activation_account, "notify"_n}, *activation_account, "assertunlock"_n,
+                std::make_tuple(dac_id))
+                .send();
+        } else {
+            // Get the token supply of the lockup asset token (eg. EOSDAC)
+            auto statsTable = stats(found_dac.symbol.get_contract(), found_dac.symbol.get_symbol().code().raw());
+            auto tokenStats = statsTable.begin();
+            check(tokenStats != statsTable.end(), "ERR::STATS_NOT_FOUND::Stats table not found");
+            LOG_DEBUG("\n\nstats: ", tokenStats->supply, " contract: ", found_dac.symbol.get_contract(),
+                " symbol: ", found_dac.symbol.get_symbol());
+
+            uint64_t token_current_supply = tokenStats->supply.amount;
+
+            auto tokenStakeConfig = stake_config::get_current_configs(found_dac.symbol.get_contract(), dac_id);
+            const double percent_of_current_voter_engagement =
+                S{globals.get_total_weight_of_votes()}.to<double>() / S{token_current_supply}.to<double>() * S{100.0};
+
+            check(token_current_supply > globals.get_token_supply_theshold(),
+                "ERR::NEWPERIOD_TOKEN_SUPPLY_TOO_LOW::Token Supply %s is insufficient to execute newperiod (%s required).",
+                token_current_supply, globals.get_token_supply_theshold());
+
+            check(globals.get_met_initial_votes_threshold() == true ||
+                      percent_of_current_voter_engagement > globals.get_initial_vote_quorum_percent(),
+                "ERR::NEWPERIOD_VOTER_ENGAGEMENT_LOW_ACTIVATE::Voter engagement %s is insufficient to activate the DAC (%s required) token_current_supply: %s total_weight_of_votes: %s.",
+                percent_of_current_voter_engagement, globals.get_initial_vote_quorum_percent(), token_current_supply,
+                globals.get_total_weight_of_votes());
+
+            check(percent_of_current_voter_engagement > globals.get_vote_quorum_percent(),
+                "ERR::NEWPERIOD_VOTER_ENGAGEMENT_LOW_PROCESS::Voter engagement is insufficient to process a new period");
+        }
+        globals.set_met_initial_votes_threshold(true);
+
+        if (!periodIsPending(dac_id)) {
+            assertPeriodTime(globals);
+            prepareCustodians(ctx);
+            globals.set_pending_period_time(current_block_time().to_time_point());
+            return;
+        }
 
-    if (!periodIsPending(dac_id)) {
-        assertPeriodTime(globals);
-        prepareCustodians(dac_id);
-        globals.set_pending_period_time(current_block_time().to_time_point());
-    } else {
         assertPendingPeriodTime(globals);
+        globals.set_period_stage(PERIOD_STAGE_PAY);
+    }
+
+    runPeriodStages(ctx);
+}
+
+/*
+ * Finishes a pending period one stage at a time. Every stage stops once the batch budget for this call is used up and
+ * leaves the stage (and its cursor) in the globals, so that the next newperiod call resumes where this one stopped.
+ */
+void daccustodian::runPeriodStages(dac_context &ctx) {
+    auto &globals = ctx.get_globals();
+    auto  budget  = globals.maybe_get_period_batch_size().value_or(DEFAULT_PERIOD_BATCH_SIZE);
+    auto  stage   = globals.maybe_get_period_stage().value_or(PERIOD_STAGE_IDLE);
+
+    // Distribute Pay is called before allocateCustodians is called to ensure custodians are paid for the just
+    // passed period. This also implies custodians should not be paid the first time this is called. Distribute
+    // pay to the current custodians.
+    if (stage == PERIOD_STAGE_PAY) {
+        if (!distributeMeanPay(ctx, budget)) {
+            return;
+        }
+        stage = PERIOD_STAGE_RETIRE;
+        globals.set_period_stage(stage);
+    }
 
-        // Distribute Pay is called before   is called to ensure custodians are paid for the just
-        // passed period. This also implies custodians should not be paid the first time this is called. Distribute
-        // pay to the current custodians.
-        distributeMeanPay(dac_id);
+    // Set custodians for the next period.
+    if (stage == PERIOD_STAGE_RETIRE) {
+        if (!retireCustodians(ctx, budget)) {
+            return;
+        }
+        stage = PERIOD_STAGE_ELECT;
+        globals.set_period_stage(stage);
+    }
 
-        // Set custodians for the next period.
-        allocateCustodians(dac_id);
+    if (stage == PERIOD_STAGE_ELECT) {
+        if (!allocateCustodians(ctx, budget)) {
+            return;
+        }
+        stage = PERIOD_STAGE_AUTH;
+        globals.set_period_stage(stage);
+    }
 
-        // Set the auths on the dacauthority account
-        setMsigAuths(dac_id);
+    // Set the auths on the dacauthority account
+    if (stage == PERIOD_STAGE_AUTH && budget > 0) {
+        setMsigAuths(ctx);
 
         globals.set_lastperiodtime(current_block_time().to_time_point());
+        globals.unset_period_stage();
     }
 }
@@ -7,8 +7,9 @@ ACTION daccustodian::claimpay(const uint64_t payid, const name &dac_id) {
     const auto  globals     = dacglobals{get_self(), dac_id};
     const auto &payClaim    = pending_pay.get(payid, "ERR::CLAIMPAY_INVALID_CLAIM_ID::Invalid pay claim id.");
 
-    assertValidMember(payClaim.receiver, dac_id);
+    assertValidMember(payClaim.receiver, dac);
     require_auth(payClaim.receiver);
+    check(payClaim.quantity.quantity.amount > 0, "ERR::CLAIMPAY_NOTHING_TO_CLAIM::There is no pay to claim.");
 
     name       payment_destination;
     string     memo;
@@ -17,12 +18,12 @@ ACTION daccustodian::claimpay(const uint64_t payid, const name &dac_id) {
     if (globals.get_should_pay_via_service_provider()) {
         const auto service_account = dac.account_for_type(dacdir::SERVICE);
         memo                       = payClaim.receiver.to_string() + ":" + memo_message + ":" + to_string(payid);
-        print("constructed memo for the service contract: " + memo);
+        LOG_DEBUG("constructed memo for the service contract: " + memo);
         payment_destination = service_account;
     } else {
         memo = memo_message + ":" + to_string(payid);
         ;
-        print("constructed memo for the receiver contract: " + memo);
+        LOG_DEBUG("constructed memo for the receiver contract: " + memo);
         payment_destination = payClaim.receiver;
     }
 
@@ -31,7 +32,15 @@ ACTION daccustodian::claimpay(const uint64_t payid, const name &dac_id) {
         std::make_tuple(token_holder, payment_destination, payClaim.quantity.quantity, memo))
         .send();
 
-    pending_pay.erase(payClaim);
+    // In pay ledger mode the row is kept at zero so that the next period's pay modifies it instead of emplacing a new
+    // one.
+    if (globals.maybe_get_pay_ledger_mode().value_or(false)) {
+        pending_pay.modify(payClaim, same_payer, [&](pay &p) {
+            p.quantity.quantity.amount = 0;
+        });
+    } else {
+        pending_pay.erase(payClaim);
+    }
 }
 
 ACTION daccustodian::removecuspay(const uint64_t payid, const name &dac_id) {
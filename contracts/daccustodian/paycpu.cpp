@@ -20,7 +20,7 @@ ACTION daccustodian::paycpu(const name &dac_id) {
     // skip buffer to max_cpu_usage_ms
     buffer += 11;
     uint8_t max_cpu_usage_ms = static_cast<uint8_t>(*buffer);
-    print("max_cpu_usage: ", max_cpu_usage_ms, "\n");
+    LOG_DEBUG("max_cpu_usage: ", max_cpu_usage_ms, "\n");
 
     check(max_cpu_usage_ms > 0 && max_cpu_usage_ms <= 5, "MAX CPU not set or above maximum");
 }
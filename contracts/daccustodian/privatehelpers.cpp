@@ -1,76 +1,122 @@
 
 using namespace eosdac;
 
-void daccustodian::updateVoteWeight(
-    name custodian, const time_point_sec vote_time_stamp, int64_t weight, name dac_id, bool from_voting) {
-    auto err = Err{"daccustodian::updateVoteWeight"};
-    if (weight == 0) {
-        print("Vote has no weight - No need to continue. ");
-        return;
+void daccustodian::applyVoteWeight(
+    candidate &c, const int64_t weight, const int128_t weight_time, const uint32_t negative_deltas) {
+    auto err = Err("daccustodian::applyVoteWeight c.total_vote_power: %s weight: %s", c.total_vote_power, weight);
+
+    const auto new_vote_power = S<uint64_t>{c.total_vote_power}.to<int64_t>() + S{weight};
+    /*
+     * Small negative deltas (1-4 tokens) may arise from integer rounding.
+     * We tolerate that drift by allowing the new vote power to dip as low as ‑4
+     * and clamping it to zero instead of rejecting the transaction.
+     * Anything below ‑4 is considered a real logic error or malicious input
+     * and will trigger `ERR:INVALID_VOTE_POWER`.
+     * When weight is the sum of several folded deltas, each negative one
+     * could have been clamped on its own, so the tolerance is per delta.
+     */
+    if (new_vote_power <= int64_t{}) {
+        // Allow small tolerance but clamp at zero
+        const auto min_vote_power = int64_t{-5} * int64_t{std::max(negative_deltas, uint32_t{1})};
+        ::check(new_vote_power > min_vote_power, "ERR:INVALID_VOTE_POWER::new_vote_power is %s", new_vote_power);
+        c.total_vote_power = 0;
+        // When vote power is clamped to zero, discard the historical accumulator to avoid unsigned underflow
+        c.running_weight_time = 0;
+
+        // Vote power is zero, so average vote-time is zero as well
+        c.avg_vote_time_stamp = time_point_sec{0};
+    } else {
+        c.total_vote_power = new_vote_power.to<uint64_t>();
+
+        // Safe to update running_weight_time – result cannot underflow because new_vote_power >= 0
+        c.running_weight_time = S<uint128_t>{c.running_weight_time}.add_signed_to_unsigned(S{weight_time});
+
+        // Re-compute average vote-time directly (running_weight_time / total_vote_power)
+        const auto delta      = S{c.running_weight_time} / S<uint64_t>{c.total_vote_power}.to<uint128_t>();
+        c.avg_vote_time_stamp = time_point_sec{delta.template to<uint32_t>()};
     }
 
-    candidates_table registered_candidates(_self, dac_id.value);
+    check(c.avg_vote_time_stamp <= now(), "avg_vote_time_stamp pushed into the future: %s", c.avg_vote_time_stamp);
+    // The rank is left to the caller, which calls update_index() once after the last applyVoteWeight of its modify.
+}
+
+void daccustodian::updateVoteWeight(candidates_table &registered_candidates, name custodian,
+    const time_point_sec vote_time_stamp, int64_t weight, int32_t voters_delta) {
+    if (weight == 0 && voters_delta == 0) {
+        LOG_DEBUG("Vote has no weight - No need to continue. ");
+        return;
+    }
 
     auto candItr = registered_candidates.find(custodian.value);
     if (candItr == registered_candidates.end()) {
-        eosio::print("Candidate not found while updating from a transfer: ", custodian);
+        LOG_DEBUG("Candidate not found while updating from a transfer: ", custodian);
         return; // trying to avoid throwing errors from here since it's unrelated to a transfer action.?!?!?!?!
     }
     registered_candidates.modify(candItr, same_payer, [&](auto &c) {
-        auto err = Err("daccustodian::updateVoteWeight c.total_vote_power: %s weight: %s", c.total_vote_power, weight);
-
-        const auto new_vote_power = S<uint64_t>{c.total_vote_power}.to<int64_t>() + S{weight};
-        /*
-         * Small negative deltas (1-4 tokens) may arise from integer rounding.
-         * We tolerate that drift by allowing the new vote power to dip as low as ‑4
-         * and clamping it to zero instead of rejecting the transaction.
-         * Anything below ‑4 is considered a real logic error or malicious input
-         * and will trigger `ERR:INVALID_VOTE_POWER`.
-         */
-        if (new_vote_power <= int64_t{}) {
-            // Allow small tolerance but clamp at zero
-            ::check(new_vote_power > int64_t{-5}, "ERR:INVALID_VOTE_POWER::new_vote_power is %s", new_vote_power);
-            c.total_vote_power = 0;
-            // When vote power is clamped to zero, discard the historical accumulator to avoid unsigned underflow
-            c.running_weight_time = 0;
-
-            // Vote power is zero, so average vote-time is zero as well
-            c.avg_vote_time_stamp = time_point_sec{0};
-        } else {
-            c.total_vote_power = new_vote_power.to<uint64_t>();
-
-            // Safe to update running_weight_time – result cannot underflow because new_vote_power >= 0
-            c.running_weight_time = S<uint128_t>{c.running_weight_time}.add_signed_to_unsigned(
-                S{weight}.to<int128_t>() * S{vote_time_stamp.sec_since_epoch()}.to<int128_t>());
-
-            // Re-compute average vote-time directly (running_weight_time / total_vote_power)
-            const auto delta      = S{c.running_weight_time} / S<uint64_t>{c.total_vote_power}.to<uint128_t>();
-            c.avg_vote_time_stamp = time_point_sec{delta.template to<uint32_t>()};
+        if (voters_delta > 0) {
+            c.number_voters = S{c.number_voters} + S{uint32_t(voters_delta)};
+        } else if (voters_delta < 0) {
+            c.number_voters = S{c.number_voters} - S{uint32_t(-voters_delta)};
+        }
+        if (weight != 0) {
+            applyVoteWeight(c, weight, vote_weight_time(weight, vote_time_stamp));
+            c.update_index();
         }
+    });
+}
 
-        check(c.avg_vote_time_stamp <= now(), "avg_vote_time_stamp pushed into the future: %s", c.avg_vote_time_stamp);
+void daccustodian::moveVoteWeight(candidates_table &registered_candidates, name custodian, int64_t weight,
+    const time_point_sec old_time_stamp, const time_point_sec new_time_stamp) {
+    if (weight == 0 || old_time_stamp == new_time_stamp) {
+        return;
+    }
 
+    auto candItr = registered_candidates.find(custodian.value);
+    if (candItr == registered_candidates.end()) {
+        LOG_DEBUG("Candidate not found while updating from a transfer: ", custodian);
+        return;
+    }
+    registered_candidates.modify(candItr, same_payer, [&](auto &c) {
+        if (S<uint64_t>{c.total_vote_power}.to<int64_t>() > weight) {
+            // Vote power is unchanged, only the weight*time of this vote moves to the new time stamp.
+            applyVoteWeight(
+                c, 0, vote_weight_time(weight, new_time_stamp) - vote_weight_time(weight, old_time_stamp));
+        } else {
+            // Removing the old vote would clamp the candidate to zero, so replay the remove-then-add sequence to keep
+            // the clamping behaviour identical.
+            applyVoteWeight(c, -weight, vote_weight_time(-weight, old_time_stamp));
+            applyVoteWeight(c, weight, vote_weight_time(weight, new_time_stamp));
+        }
         c.update_index();
     });
 }
 
-void daccustodian::updateVoteWeights(const vector<name> &votes, const time_point_sec vote_time_stamp,
-    int64_t vote_weight, name dac_id, bool from_voting) {
+void daccustodian::applyCandidateWeightDeltas(
+    candidates_table &registered_candidates, const std::map<name, candidate_weight_delta> &deltas) {
+    for (const auto &[custodian, delta] : deltas) {
+        if (delta.weight == 0 && delta.weight_time == 0) {
+            continue;
+        }
 
-    for (const auto &cust : votes) {
-        updateVoteWeight(cust, vote_time_stamp, vote_weight, dac_id, from_voting);
+        auto candItr = registered_candidates.find(custodian.value);
+        if (candItr == registered_candidates.end()) {
+            LOG_TRACE("Candidate not found while updating from a transfer: ", custodian);
+            continue;
+        }
+        registered_candidates.modify(candItr, same_payer, [&](auto &c) {
+            applyVoteWeight(c, delta.weight, delta.weight_time, delta.negative_deltas);
+            c.update_index();
+        });
     }
 }
 
-std::pair<int64_t, int64_t> daccustodian::get_vote_weight(name voter, name dac_id) {
-
-    dacdir::dac found_dac = dacdir::dac_for_id(dac_id);
-
+std::pair<int64_t, int64_t> daccustodian::get_vote_weight(name voter, dac_context &ctx) {
+    const auto     &found_dac     = ctx.get_dac();
     const auto      vote_contract = found_dac.account_for_type_maybe(dacdir::VOTE_WEIGHT);
     extended_symbol token_symbol  = found_dac.symbol;
 
     if (vote_contract) {
-        weights weights_table(*vote_contract, dac_id.value);
+        weights weights_table(*vote_contract, ctx.dac_id.value);
         auto    weight_itr = weights_table.find(voter.value);
         if (weight_itr != weights_table.end()) {
             return {weight_itr->weight, weight_itr->weight_quorum};
@@ -89,39 +135,59 @@ std::pair<int64_t, int64_t> daccustodian::get_vote_weight(name voter, name dac_i
 
 void daccustodian::modifyVoteWeights(const account_weight_delta &awd, const vector<name> &oldVotes,
     const std::optional<time_point_sec> &oldVoteTimestamp, const vector<name> &newVotes, time_point_sec new_time_stamp,
-    const name dac_id, const bool from_voting) {
+    dac_context &ctx, const bool from_voting) {
     auto err = Err{"daccustodian::modifyVoteWeights"};
-    // This could be optimised with set diffing to avoid remove then add for unchanged votes. - later
 
     if (awd.weight_delta == 0) {
-        print("Voter has no weight therefore no need to update vote weights");
-        return;
-    }
+        LOG_DEBUG("Voter has no weight therefore no need to update vote weights");
+        if (!from_voting) {
+            return;
+        }
+    } else {
+        auto &globals = ctx.get_globals();
 
-    auto globals = dacglobals{get_self(), dac_id};
+        // New voter -> Add the tokens to the total weight.
+        auto total_weight_of_votes            = S{globals.get_total_weight_of_votes()};
+        auto total_stake_time_weight_of_votes = S{globals.get_total_votes_on_candidates()};
 
-    // New voter -> Add the tokens to the total weight.
-    auto total_weight_of_votes            = S{globals.get_total_weight_of_votes()};
-    auto total_stake_time_weight_of_votes = S{globals.get_total_votes_on_candidates()};
+        if (oldVotes.size() == 0) {
+            total_weight_of_votes += S{awd.weight_delta_quorum};
+            total_stake_time_weight_of_votes += S{awd.weight_delta};
+        }
 
-    if (oldVotes.size() == 0) {
-        total_weight_of_votes += S{awd.weight_delta_quorum};
-        total_stake_time_weight_of_votes += S{awd.weight_delta};
-    }
+        // Leaving voter -> Remove the tokens to the total weight.
+        if (newVotes.size() == 0) {
+            total_weight_of_votes -= S{awd.weight_delta_quorum};
+            total_stake_time_weight_of_votes -= S{awd.weight_delta};
+        }
 
-    // Leaving voter -> Remove the tokens to the total weight.
-    if (newVotes.size() == 0) {
-        total_weight_of_votes -= S{awd.weight_delta_quorum};
-        total_stake_time_weight_of_votes -= S{awd.weight_delta};
+        globals.set_total_weight_of_votes(total_weight_of_votes);
+        globals.set_total_votes_on_candidates(total_stake_time_weight_of_votes);
     }
 
-    globals.set_total_weight_of_votes(total_weight_of_votes);
-    globals.set_total_votes_on_candidates(total_stake_time_weight_of_votes);
+    // Diff the old and new votes so that only candidates whose weight or number of voters actually change get
+    // modified. Candidates present in both lists keep their vote power and only have the weight*time of this vote
+    // moved to the new time stamp.
+    auto       registered_candidates = candidates_table{get_self(), ctx.dac_id.value};
+    const auto voters_delta          = from_voting ? int32_t{1} : int32_t{0};
+    const auto old_weight            = oldVoteTimestamp.has_value() ? awd.weight_delta : int64_t{};
+
+    for (const auto &cust : oldVotes) {
+        if (std::find(newVotes.begin(), newVotes.end(), cust) == newVotes.end()) {
+            updateVoteWeight(
+                registered_candidates, cust, oldVoteTimestamp.value_or(time_point_sec{}), -old_weight, -voters_delta);
+        }
+    }
 
-    if (oldVoteTimestamp.has_value()) {
-        updateVoteWeights(oldVotes, *oldVoteTimestamp, -awd.weight_delta, dac_id, from_voting);
+    for (const auto &cust : newVotes) {
+        if (std::find(oldVotes.begin(), oldVotes.end(), cust) == oldVotes.end()) {
+            updateVoteWeight(registered_candidates, cust, new_time_stamp, awd.weight_delta, voters_delta);
+        } else if (oldVoteTimestamp.has_value()) {
+            moveVoteWeight(registered_candidates, cust, awd.weight_delta, *oldVoteTimestamp, new_time_stamp);
+        } else {
+            updateVoteWeight(registered_candidates, cust, new_time_stamp, awd.weight_delta, 0);
+        }
     }
-    updateVoteWeights(newVotes, new_time_stamp, awd.weight_delta, dac_id, from_voting);
 }
 
 permission_level daccustodian::getCandidatePermission(name account, name dac_id) {
@@ -131,7 +197,10 @@ permission_level daccustodian::getCandidatePermission(name account, name dac_id)
     if (perm == cand_perms.end()) {
         return permission_level{account, "active"_n};
     } else {
-        if (permissionExists(account, perm->permission)) {
+        // Use the result cached by setperm/revalperm when there is one rather than repeating the expensive check.
+        const auto perm_exists = perm->permission_exists.has_value() ? perm->permission_exists.value()
+                                                                      : permissionExists(account, perm->permission);
+        if (perm_exists) {
             return permission_level{account, perm->permission};
         } else {
             return permission_level{account, "active"_n};
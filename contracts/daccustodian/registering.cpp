@@ -5,8 +5,9 @@ using namespace eosdac;
 
 ACTION daccustodian::nominatecane(const name &cand, const asset &requestedpay, const name &dac_id) {
     require_auth(cand);
-    assertValidMember(cand, dac_id);
-    auto globals = dacglobals{get_self(), dac_id};
+    auto  ctx     = dac_context{get_self(), dac_id};
+    auto &globals = ctx.get_globals();
+    assertValidMember(cand, ctx.get_dac());
 
     if (globals.maybe_get_requires_whitelist().has_value() && globals.maybe_get_requires_whitelist().value() == true) {
         whitelist_table whitelist(get_self(), dac_id.value);
@@ -18,7 +19,7 @@ ACTION daccustodian::nominatecane(const name &cand, const asset &requestedpay, c
     check(requestedpay <= globals.get_requested_pay_max().quantity,
         "ERR::NOMINATECAND_PAY_LIMIT_EXCEEDED::Requested pay limit for a candidate was exceeded.");
 
-    validateMinStake(cand, dac_id);
+    validateMinStake(cand, ctx);
 
     const auto number_active_candidates = globals.get_number_active_candidates();
     globals.set_number_active_candidates(S{number_active_candidates} + S<uint32_t>{1});
@@ -32,6 +33,7 @@ ACTION daccustodian::nominatecane(const name &cand, const asset &requestedpay, c
         registered_candidates.modify(reg_candidate, cand, [&](candidate &c) {
             c.is_active    = 1;
             c.requestedpay = requestedpay;
+            c.update_index();
         });
     } else {
         registered_candidates.emplace(cand, [&](candidate &c) {
@@ -54,37 +56,40 @@ ACTION daccustodian::withdrawcane(const name &cand, const name &dac_id) {
     const auto &reg_candidate         = registered_candidates.get(
         cand.value, "ERR::REMOVECANDIDATE_NOT_CURRENT_CANDIDATE::Candidate is not already registered.");
     check(reg_candidate.is_active, "ERR::REMOVECANDIDATE_CANDIDATE_NOT_ACTIVE::Candidate is not active.");
-    disableCandidate(cand, dac_id);
+    auto ctx = dac_context{get_self(), dac_id};
+    disableCandidate(cand, ctx);
 }
 
 // No longer necessary, can be removed in the future. Kept for now for backwards compatibility.
 ACTION daccustodian::removecand(const name &cand, const name &dac_id) {
     require_auth(cand);
     // Do *not* erase the candidate row anymore; just mark it inactive.
-    disableCandidate(cand, dac_id);
+    auto ctx = dac_context{get_self(), dac_id};
+    disableCandidate(cand, ctx);
 }
 
 // if dac owner wants to forcibly remove a candidate
 ACTION daccustodian::firecand(const name &cand, const bool lockupStake, const name &dac_id) {
-    auto dac = dacdir::dac_for_id(dac_id);
-    require_auth(dac.owner);
+    auto ctx = dac_context{get_self(), dac_id};
+    require_auth(ctx.get_dac().owner);
     check(false, "This feature is currently disabled.");
     // If re-enabled in the future, only mark candidate inactive.
-    disableCandidate(cand, dac_id);
+    disableCandidate(cand, ctx);
 }
 
 ACTION daccustodian::resigncust(const name &cust, const name &dac_id) {
     require_auth(cust);
-    removeCustodian(cust, dac_id);
+    auto ctx = dac_context{get_self(), dac_id};
+    removeCustodian(cust, ctx);
 }
 
 ACTION daccustodian::firecust(const name &cust, const name &dac_id) {
-    auto dac = dacdir::dac_for_id(dac_id);
-    require_auth(dac.owner);
+    auto ctx = dac_context{get_self(), dac_id};
+    require_auth(ctx.get_dac().owner);
     check(false, "This feature is currently disabled.");
-    removeCustodian(cust, dac_id);
+    removeCustodian(cust, ctx);
     // Only deactivate candidate; do not erase row.
-    disableCandidate(cust, dac_id);
+    disableCandidate(cust, ctx);
 }
 
 ACTION daccustodian::setperm(const name &cand, const name &permission, const name &dac_id) {
@@ -105,16 +110,41 @@ ACTION daccustodian::setperm(const name &cand, const name &permission, const nam
         cand_perms.emplace(cand, [&](candperm &c) {
             c.cand       = cand;
             c.permission = permission;
+            c.permission_exists.emplace(perm_exists);
+            c.validated_at.emplace(now());
         });
     } else if (permission == "active"_n) {
         cand_perms.erase(existing);
     } else {
-        cand_perms.modify(existing, same_payer, [&](candperm &c) {
+        cand_perms.modify(existing, cand, [&](candperm &c) {
             c.permission = permission;
+            c.permission_exists.emplace(perm_exists);
+            c.validated_at.emplace(now());
         });
     }
 }
 
+// Permissionless on purpose: a custodian who deletes their custom permission must not be able to block the next
+// authority rebuild by refusing to revalidate it.
+ACTION daccustodian::revalperm(const name &cand, const name &dac_id) {
+    candperms_table cand_perms(_self, dac_id.value);
+    const auto      existing =
+        cand_perms.require_find(cand.value, "ERR::REVALPERM_NO_CUSTOM_PERMISSION::Candidate has no custom permission.");
+
+    const auto perm_exists = permissionExists(cand, existing->permission);
+    if (!existing->permission_exists.has_value() || existing->permission_exists.value() != perm_exists) {
+        // The effective authority may change (legacy rows were never cached), so make sure the next setMsigAuths does
+        // not skip the update.
+        auto globals = dacglobals{get_self(), dac_id};
+        globals.unset_auth_fingerprint();
+    }
+
+    cand_perms.modify(existing, has_auth(cand) ? cand : get_self(), [&](candperm &c) {
+        c.permission_exists.emplace(perm_exists);
+        c.validated_at.emplace(now());
+    });
+}
+
 ACTION daccustodian::appointcust(const vector<name> &custs, const name &dac_id) {
 #ifndef IS_DEV
     check(false, "Custodians can only be appointed via elections.");
@@ -150,13 +180,14 @@ ACTION daccustodian::appointcust(const vector<name> &custs, const name &dac_id)
             c.requestedpay = req_pay.quantity;
         });
     }
+    publishCustodianSet(dac_id);
 }
 
 // private methods for the above actions
 
-void daccustodian::validateMinStake(name account, name dac_id) {
-    const auto globals        = dacglobals{get_self(), dac_id};
-    const auto required_stake = globals.get_lockupasset();
+void daccustodian::validateMinStake(name account, dac_context &ctx) {
+    const auto &globals        = ctx.get_globals();
+    const auto  required_stake = globals.get_lockupasset();
 
     if (required_stake.quantity.amount > 0) {
         const auto staked = eosdac::get_staked(account, required_stake.contract, required_stake.quantity.symbol);
@@ -165,40 +196,44 @@ void daccustodian::validateMinStake(name account, name dac_id) {
             "ERR::VALIDATEMINSTAKE_NOT_ENOUGH::Not staked enough. You staked %s, but need to stake at least %s", staked,
             required_stake.quantity);
 
-        const auto delay     = staketime_info::get_delay("token.worlds"_n, dac_id, account);
+        const auto delay     = staketime_info::get_delay("token.worlds"_n, ctx.dac_id, account);
         const auto min_delay = globals.get_lockup_release_time_delay();
         check(delay >= min_delay, "ERR::VALIDATEMINSTAKE_NOT_LONG_ENOUGH::Staketime must be at least %s but is %s",
             min_delay, delay);
     }
 }
 
-void daccustodian::removeCustodian(name cust, name dac_id) {
+void daccustodian::removeCustodian(name cust, dac_context &ctx) {
+    // The custodians table is only partially rotated while a period is being finished.
+    check(ctx.get_globals().maybe_get_period_stage().value_or(PERIOD_STAGE_IDLE) == PERIOD_STAGE_IDLE,
+        "ERR::REMOVECUSTODIAN_PERIOD_IN_PROGRESS::Cannot remove a custodian while a new period is being processed.");
 
-    custodians_table custodians(_self, dac_id.value);
+    custodians_table custodians(_self, ctx.dac_id.value);
     auto             elected = custodians.require_find(cust.value,
                     "ERR::REMOVECUSTODIAN_NOT_CURRENT_CUSTODIAN::The entered account name is not for a current custodian.");
     custodians.erase(elected);
+    publishCustodianSet(ctx.dac_id);
 
-    pending_custodians_table pending_custs(get_self(), dac_id.value);
+    pending_custodians_table pending_custs(get_self(), ctx.dac_id.value);
 
     auto pending = pending_custs.find(cust.value);
     if (pending != pending_custs.end()) {
         pending_custs.erase(pending);
     }
     // Remove the candidate from being eligible for the next election period.
-    disableCandidate(cust, dac_id);
+    disableCandidate(cust, ctx);
 
     // Rather than allocate to fill the gaps leave the gap to avoid nasty suprises from newly added custodians.
 
     // Update the auths to give control to the new set of custodians.
     // If too many are removed to satisfy the auth this should fail and therefore prevent the custodian to withdraw
     // before the end of the period.
-    setMsigAuths(dac_id);
+    setMsigAuths(ctx);
 }
 
 // inactivate the candidate by setting is_active to false and decrementing the count of active candidates
-void daccustodian::disableCandidate(name cand, name dac_id) {
-    auto        registered_candidates = candidates_table{_self, dac_id.value};
+void daccustodian::disableCandidate(name cand, dac_context &ctx) {
+    auto        registered_candidates = candidates_table{_self, ctx.dac_id.value};
     const auto &reg_candidate         = registered_candidates.get(
         cand.value, "ERR::REMOVECANDIDATE_NOT_CURRENT_CANDIDATE::Candidate is not already registered.");
 
@@ -206,19 +241,22 @@ void daccustodian::disableCandidate(name cand, name dac_id) {
         return;
     }
 
-    auto       globals                  = dacglobals{get_self(), dac_id};
+    auto      &globals                  = ctx.get_globals();
     const auto number_active_candidates = globals.get_number_active_candidates();
     globals.set_number_active_candidates(S{number_active_candidates} - S<uint32_t>{1});
 
-    eosio::print("Remove from nominated candidate by setting them to inactive.");
+    LOG_DEBUG("Remove from nominated candidate by setting them to inactive.");
     // Set the is_active flag to false instead of deleting in order to retain votes if they return to he dac.
     registered_candidates.modify(reg_candidate, same_payer, [&](auto &c) {
         c.is_active = 0;
+        c.update_index();
     });
 }
 
 ACTION daccustodian::regproxy(const name &proxy_member, const name &dac_id) {
+#ifndef IS_DEV
     check(false, "proxy voting not yet enabled.");
+#endif
     require_auth(proxy_member);
     assertValidMember(proxy_member, dac_id);
 
@@ -245,8 +283,9 @@ ACTION daccustodian::unregproxy(const name &proxy_member, const name &dac_id) {
         votes_table votes_cast_by_members(_self, dac_id.value);
         auto        existingVote = votes_cast_by_members.find(proxy_member.value);
         if (existingVote != votes_cast_by_members.end()) {
+            auto ctx = dac_context{get_self(), dac_id};
             modifyVoteWeights({name{}, found_proxy->total_weight, found_proxy->total_weight}, existingVote->candidates,
-                existingVote->vote_time_stamp, {}, now(), dac_id, false);
+                existingVote->vote_time_stamp, {}, now(), ctx, false);
         }
     }
 
@@ -6,20 +6,20 @@ ACTION daccustodian::votecust(const name &voter, const vector<name> &newvotes, c
 #endif
 
     candidates_table registered_candidates(_self, dac_id.value);
-    const auto       globals = dacglobals{get_self(), dac_id};
+    auto             ctx = dac_context{get_self(), dac_id};
 
     check(!maintenance_mode(), "Voting is currently disabled for maintenance. Please try again in a few minutes");
 
     require_auth(voter);
-    assertValidMember(voter, dac_id);
-    check(newvotes.size() <= globals.get_maxvotes(),
+    assertValidMember(voter, ctx.get_dac());
+    check(newvotes.size() <= ctx.get_globals().get_maxvotes(),
         "ERR::VOTECUST_MAX_VOTES_EXCEEDED::Max number of allowed votes was exceeded.");
     std::set<name> dupSet{};
-    assertValidMembers(newvotes, dac_id);
+    assertValidMembers(newvotes, ctx.get_dac());
     for (name vote : newvotes) {
         check(
             dupSet.insert(vote).second, "ERR::VOTECUST_DUPLICATE_VOTES::Added duplicate votes for the same candidate.");
-        auto candidate =
+        const auto &candidate =
             registered_candidates.get(vote.value, "ERR::VOTECUST_CANDIDATE_NOT_FOUND::Candidate could not be found.");
         check(candidate.is_active,
             "ERR::VOTECUST_VOTING_FOR_INACTIVE_CAND::Attempting to vote for an inactive candidate.");
@@ -29,17 +29,15 @@ ACTION daccustodian::votecust(const name &voter, const vector<name> &newvotes, c
     auto votes_cast_by_members = votes_table{_self, dac_id.value};
     auto existingVote          = votes_cast_by_members.find(voter.value);
 
-    const auto [vote_weight, vote_weight_quorum] = get_vote_weight(voter, dac_id);
+    const auto [vote_weight, vote_weight_quorum] = get_vote_weight(voter, ctx);
     if (existingVote != votes_cast_by_members.end()) {
-        update_number_of_votes(existingVote->candidates, newvotes, dac_id);
-
         modifyVoteWeights({voter, vote_weight, vote_weight_quorum}, existingVote->candidates,
-            existingVote->vote_time_stamp, newvotes, now(), dac_id, true);
+            existingVote->vote_time_stamp, newvotes, now(), ctx, true);
 
         if (newvotes.size() == 0) {
             // Remove the vote if the array of candidates is empty
             votes_cast_by_members.erase(existingVote);
-            eosio::print("\n Removing empty vote.");
+            LOG_TRACE("\n Removing empty vote.");
         } else {
             votes_cast_by_members.modify(existingVote, voter, [&](vote &v) {
                 v.candidates      = newvotes;
@@ -50,9 +48,7 @@ ACTION daccustodian::votecust(const name &voter, const vector<name> &newvotes, c
         }
 
     } else {
-        update_number_of_votes({}, newvotes, dac_id);
-
-        modifyVoteWeights({voter, vote_weight, vote_weight_quorum}, {}, {}, newvotes, now(), dac_id, true);
+        modifyVoteWeights({voter, vote_weight, vote_weight_quorum}, {}, {}, newvotes, now(), ctx, true);
 
         votes_cast_by_members.emplace(voter, [&](vote &v) {
             v.voter           = voter;
@@ -67,32 +63,10 @@ ACTION daccustodian::removecstvte(const name &voter, const name &dac_id) {
     votecust(voter, {}, dac_id);
 }
 
-void daccustodian::update_number_of_votes(
-    const vector<name> &oldvotes, const vector<name> &newvotes, const name &dac_id) {
-    auto registered_candidates = candidates_table{get_self(), dac_id.value};
-
-    for (const auto candidate : oldvotes) {
-        auto candItr = registered_candidates.find(candidate.value);
-        if (candItr != registered_candidates.end()) {
-            registered_candidates.modify(candItr, same_payer, [&](auto &c) {
-                c.number_voters = S{c.number_voters} - S{uint32_t{1}};
-            });
-        }
-    }
-    for (const auto candidate : newvotes) {
-        auto candItr = registered_candidates.find(candidate.value);
-        if (candItr != registered_candidates.end()) {
-            registered_candidates.modify(candItr, same_payer, [&](auto &c) {
-                c.number_voters = S{c.number_voters} + S{uint32_t{1}};
-            });
-        }
-    }
-}
-
 void daccustodian::modifyProxiesWeight(
-    int64_t vote_weight, name oldProxy, name newProxy, name dac_id, bool from_voting) {
-    proxies_table proxies(get_self(), dac_id.value);
-    votes_table   votes_cast_by_members(_self, dac_id.value);
+    int64_t vote_weight, name oldProxy, name newProxy, dac_context &ctx, bool from_voting) {
+    proxies_table proxies(get_self(), ctx.dac_id.value);
+    votes_table   votes_cast_by_members(_self, ctx.dac_id.value);
 
     auto oldProxyRow = proxies.find(oldProxy.value);
 
@@ -123,11 +97,8 @@ void daccustodian::modifyProxiesWeight(
         }
     }
 
-    if (from_voting) {
-        update_number_of_votes(oldProxyVotes, newProxyVotes, dac_id);
-    }
     modifyVoteWeights(
-        {name{}, vote_weight, vote_weight}, oldProxyVotes, oldVoteTimestamp, newProxyVotes, now(), dac_id, from_voting);
+        {name{}, vote_weight, vote_weight}, oldProxyVotes, oldVoteTimestamp, newProxyVotes, now(), ctx, from_voting);
 }
 
 ACTION daccustodian::voteproxy(const name &voter, const name &proxyName, const name &dac_id) {
@@ -135,7 +106,8 @@ ACTION daccustodian::voteproxy(const name &voter, const name &proxyName, const n
     check(false, "proxy voting not yet enabled.");
 #endif
     require_auth(voter);
-    assertValidMember(voter, dac_id);
+    auto ctx = dac_context{get_self(), dac_id};
+    assertValidMember(voter, ctx.get_dac());
 
     string error_msg = "Member cannot proxy vote for themselves: " + voter.to_string();
     check(voter != proxyName, error_msg.c_str());
@@ -160,7 +132,7 @@ ACTION daccustodian::voteproxy(const name &voter, const name &proxyName, const n
     name oldProxy;
     name newProxy;
 
-    const auto [vote_weight, vote_weight_quorum] = get_vote_weight(voter, dac_id);
+    const auto [vote_weight, vote_weight_quorum] = get_vote_weight(voter, ctx);
 
     // Find a vote that has been cast by this voter previously.
     auto existingVote = votes_cast_by_members.find(voter.value);
@@ -191,11 +163,30 @@ ACTION daccustodian::voteproxy(const name &voter, const name &proxyName, const n
         newProxy = proxyName;
     }
 
-    modifyProxiesWeight(vote_weight, oldProxy, newProxy, dac_id, true);
+    modifyProxiesWeight(vote_weight, oldProxy, newProxy, ctx, true);
+}
+
+// Refreshes the rank of up to batch_size candidates starting at from, so rows ranked under older rules (e.g.
+// inactive candidates that kept their vote rank) sort correctly. Call again from the next candidate name until done.
+void daccustodian::rerankcands(const name &dac_id, const name &from, const uint16_t batch_size) {
+    require_auth(get_self());
+    check(batch_size > 0, "ERR::RERANKCANDS_INVALID_BATCH_SIZE::The batch size must be greater than zero.");
+
+    auto candidates = candidates_table{get_self(), dac_id.value};
+    auto cand_itr   = candidates.lower_bound(from.value);
+    auto processed  = uint16_t{0};
+    while (cand_itr != candidates.end() && processed < batch_size) {
+        candidates.modify(cand_itr, same_payer, [&](auto &c) {
+            c.update_index();
+            c.gap_filler = 0;
+        });
+        cand_itr++;
+        processed++;
+    }
 }
 
 #if defined(IS_DEV) || defined(DEBUG)
-// Used for testing migraterank
+// Used for testing migraterank and rerankcands
 void daccustodian::clearrank(const name &dac_id) {
     require_auth(get_self());
     auto candidates = candidates_table{get_self(), dac_id.value};
@@ -217,4 +208,17 @@ void daccustodian::migraterank(const name &dac_id) {
         });
     }
 }
+
+void daccustodian::checkrank(const vector<pair<uint64_t, uint32_t>> &samples) {
+    for (const auto &[total_vote_power, avg_vote_time_stamp] : samples) {
+        auto c                = candidate{};
+        c.total_vote_power    = total_vote_power;
+        c.avg_vote_time_stamp = time_point_sec{avg_vote_time_stamp};
+
+        const auto fixed = c.calc_decayed_votes_index();
+        const auto dbl   = c.calc_decayed_votes_index_double();
+        check(fixed == dbl, "ERR::CHECKRANK_MISMATCH::vote power: %s vote time: %s fixed: %s double: %s",
+            total_vote_power, avg_vote_time_stamp, fixed, dbl);
+    }
+}
 #endif
@@ -0,0 +1,174 @@
+import { Account, assertEOSErrorIncludesMessage } from 'lamington';
+import { SharedTestObjects } from '../TestHelpers';
+import * as chai from 'chai';
+
+/*
+  weightobsv folds the deltas of a batch into one write per candidate and proxy.
+  Applied one by one, every negative delta that took a candidate slightly below
+  zero was clamped on its own (see applyVoteWeight), so the folded sum must
+  tolerate the same drift:
+  1.  voter (10 units) votes for candidate, proxyVoter (100 units) proxies to
+      proxy (1 unit) who votes for proxyCandidate.
+  2.  One batch with -12 and -3 for voter and -104 and -4 for proxyVoter.
+      Applied in sequence each step clamps at zero, so the batch must succeed.
+*/
+
+describe('Daccustodian weightobsv folding', () => {
+  const dacId = 'folddac';
+  let shared: SharedTestObjects;
+  let voter: Account;
+  let proxyVoter: Account;
+  let proxy: Account;
+  let candidate: Account;
+  let proxyCandidate: Account;
+
+  const getGlobal = async (key: string) => {
+    const res = await shared.daccustodian_contract.dacglobalsTable({
+      scope: dacId,
+    });
+    const entry = res.rows[0].data.find((x: any) => x.key == key);
+    return Number(entry.value[1]);
+  };
+  const getCandidate = async (cand: Account) => {
+    const res = await shared.daccustodian_contract.candidatesTable({
+      scope: dacId,
+      lowerBound: cand.name,
+      upperBound: cand.name,
+    });
+    return res.rows[0];
+  };
+
+  before(async () => {
+    shared = await SharedTestObjects.getInstance();
+    await shared.initDac(dacId, '4,FOLD', '1000000.0000 FOLD');
+    await shared.updateconfig(dacId, '12.0000 FOLD');
+    await shared.dac_token_contract.stakeconfig(
+      { enabled: true, min_stake_time: 1233, max_stake_time: 1500 },
+      '4,FOLD',
+      { from: shared.auth_account }
+    );
+
+    [voter] = await shared.getRegMembers(dacId, '0.0010 FOLD', 1);
+    [proxyVoter] = await shared.getRegMembers(dacId, '0.0100 FOLD', 1);
+    [proxy] = await shared.getRegMembers(dacId, '0.0001 FOLD', 1);
+    [candidate, proxyCandidate] = await shared.getRegMembers(
+      dacId,
+      '100.0000 FOLD',
+      2
+    );
+    for (const cand of [candidate, proxyCandidate]) {
+      await shared.dac_token_contract.stake(cand.name, '12.0000 FOLD', {
+        from: cand,
+      });
+      await shared.daccustodian_contract.nominatecane(
+        cand.name,
+        '0.0000 EOS',
+        dacId,
+        { from: cand }
+      );
+    }
+
+    await shared.daccustodian_contract.votecust(
+      voter.name,
+      [candidate.name],
+      dacId,
+      { from: voter }
+    );
+    await shared.daccustodian_contract.regproxy(proxy.name, dacId, {
+      from: proxy,
+    });
+    await shared.daccustodian_contract.votecust(
+      proxy.name,
+      [proxyCandidate.name],
+      dacId,
+      { from: proxy }
+    );
+    await shared.daccustodian_contract.voteproxy(
+      proxyVoter.name,
+      proxy.name,
+      dacId,
+      { from: proxyVoter }
+    );
+  });
+
+  it('should start from the expected weights', async () => {
+    chai
+      .expect(Number((await getCandidate(candidate)).total_vote_power))
+      .to.equal(10);
+    chai
+      .expect(Number((await getCandidate(proxyCandidate)).total_vote_power))
+      .to.equal(101);
+  });
+
+  it('should clamp a folded batch the same way as single deltas', async () => {
+    const totalWeightBefore = await getGlobal('total_weight_of_votes');
+    const totalVotesBefore = await getGlobal('total_votes_on_candidates');
+
+    await shared.daccustodian_contract.weightobsv(
+      [
+        { account: voter.name, weight_delta: -12, weight_delta_quorum: -12 },
+        { account: voter.name, weight_delta: -3, weight_delta_quorum: -3 },
+        {
+          account: proxyVoter.name,
+          weight_delta: -104,
+          weight_delta_quorum: -104,
+        },
+        {
+          account: proxyVoter.name,
+          weight_delta: -4,
+          weight_delta_quorum: -4,
+        },
+      ],
+      dacId,
+      { from: shared.dac_token_contract.account }
+    );
+
+    const cand = await getCandidate(candidate);
+    chai.expect(Number(cand.total_vote_power)).to.equal(0);
+    chai.expect(Number(cand.running_weight_time)).to.equal(0);
+    const proxyCand = await getCandidate(proxyCandidate);
+    chai.expect(Number(proxyCand.total_vote_power)).to.equal(0);
+    chai.expect(Number(proxyCand.running_weight_time)).to.equal(0);
+
+    const proxies = await shared.daccustodian_contract.proxiesTable({
+      scope: dacId,
+      lowerBound: proxy.name,
+      upperBound: proxy.name,
+    });
+    chai.expect(Number(proxies.rows[0].total_weight)).to.equal(-8);
+
+    chai
+      .expect(await getGlobal('total_weight_of_votes'))
+      .to.equal(totalWeightBefore - 123);
+    chai
+      .expect(await getGlobal('total_votes_on_candidates'))
+      .to.equal(totalVotesBefore - 123);
+  });
+
+  it('should still reject a drift beyond the tolerance', async () => {
+    await shared.daccustodian_contract.weightobsv(
+      [{ account: voter.name, weight_delta: 20, weight_delta_quorum: 20 }],
+      dacId,
+      { from: shared.dac_token_contract.account }
+    );
+    await assertEOSErrorIncludesMessage(
+      shared.daccustodian_contract.weightobsv(
+        [
+          {
+            account: voter.name,
+            weight_delta: -15,
+            weight_delta_quorum: -15,
+          },
+          {
+            account: voter.name,
+            weight_delta: -15,
+            weight_delta_quorum: -15,
+          },
+        ],
+        dacId,
+        { from: shared.dac_token_contract.account }
+      ),
+      'ERR:INVALID_VOTE_POWER'
+    );
+  });
+});
@@ -26,7 +26,8 @@ namespace eosdac {
         check(arb_itr->rating > 0, "ERR::ARBITER_NOT_ACTIVE::Arbiter is not rated enough to be active.");
 
         require_auth(proposer);
-        assertValidMember(proposer, dac_id);
+        auto dac = dacdir::dac_for_id(dac_id);
+        assertValidMember(proposer, dac);
         proposal_table proposals(get_self(), dac_id.value);
 
         check(proposer != arbiter, "You cannot nominate yourself as the arbiter for a proposal.");
@@ -34,6 +35,11 @@ namespace eosdac {
         check(proposals.find(id.value) == proposals.end(),
             "ERR::CREATEPROP_DUPLICATE_ID::A Proposal with the id already exists. Try again with a different id.");
 
+        check_votes_migrated(dac_id);
+        const auto tombstones = tombstones_table{get_self(), dac_id.value};
+        check(tombstones.find(id.value) == tombstones.end(),
+            "ERR::CREATEPROP_ID_NOT_PURGED::The votes of a removed proposal with this id have not been purged yet.");
+
         check(title.length() > 3, "ERR::CREATEPROP_SHORT_TITLE::Title length is too short.");
         check(title.length() < 256, "ERR::CREATEPROP_LONG_TITLE::Title length is too long.");
 
@@ -44,7 +50,6 @@ namespace eosdac {
             "ERR::CREATEPROP_INVALID_proposal_pay::Invalid pay amount. Must be greater than 0.");
         check(is_account(arbiter), "ERR::CREATEPROP_INVALID_arbiter::Invalid arbiter.");
 
-        auto dac              = dacdir::dac_for_id(dac_id);
         auto dao_msig_account = dac.account_for_type(dacdir::MSIGOWNED);
         auto auth             = dac.owner;
         check(arbiter != auth && arbiter != dao_msig_account, "arbiter must be a third party");
@@ -129,21 +134,62 @@ namespace eosdac {
         }
     }
 
-    bool dacproposals::is_current_custodian(name custodian, name dac_id) {
+    custodian_set dacproposals::current_custodians(name dac_id) {
         auto custodian_data_src = dacdir::dac_for_id(dac_id).account_for_type(dacdir::CUSTODIAN);
-        auto custodians         = custodians_table(custodian_data_src, dac_id.value);
-        auto itr                = custodians.find(custodian.value);
-        return itr != custodians.end();
+        return get_custodian_set(custodian_data_src, dac_id);
     }
 
     void dacproposals::_voteprop(name custodian, name proposal_id, name vote, name dac_id) {
         require_auth(custodian);
 
         assertValidMember(custodian, dac_id);
-        check(is_current_custodian(custodian, dac_id), "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
+        const auto custodians = current_custodians(dac_id);
+        check(custodians.contains(custodian), "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
+        check_votes_migrated(dac_id);
 
         auto proposals = proposal_table{_self, dac_id.value};
+        apply_vote(proposals, custodian, proposal_id, vote, custodians, dac_id);
+    }
+
+    ACTION dacproposals::votepropmany(name custodian, vector<pair<name, name>> votes, name dac_id) {
+        require_auth(custodian);
+
+        assertValidMember(custodian, dac_id);
+        const auto custodians = current_custodians(dac_id);
+        check(custodians.contains(custodian), "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
+        check_votes_migrated(dac_id);
+
+        auto           proposals = proposal_table{_self, dac_id.value};
+        std::set<name> voted_proposals;
+        for (const auto &[proposal_id, vote] : votes) {
+            check(voted_proposals.insert(proposal_id).second,
+                "ERR::VOTEPROPMANY_DUPLICATE_PROPOSAL::Proposal %s appears more than once.", proposal_id);
+
+            const auto &prop =
+                proposals.get(proposal_id.value, "ERR::VOTEPROP_PROPOSAL_NOT_FOUND::Proposal not found.");
+            const auto finalizing = prop.state == STATE_PENDING_FINALIZE || prop.state == STATE_HAS_ENOUGH_FIN_VOTES;
+            switch (VoteTypePublic{vote.value}) {
+            case vote_approve:
+                apply_vote(proposals, custodian, proposal_id, finalizing ? VOTE_FINAL_APPROVE : VOTE_PROP_APPROVE,
+                    custodians, dac_id);
+                break;
+            case vote_deny:
+                apply_vote(proposals, custodian, proposal_id, finalizing ? VOTE_FINAL_DENY : VOTE_PROP_DENY,
+                    custodians, dac_id);
+                break;
+            case vote_abstain:
+                apply_vote(proposals, custodian, proposal_id, ""_n, custodians, dac_id);
+                break;
+            default:
+                check(false, "votepropmany called with invalid vote type %s. Allowed %s or %s", vote, VOTE_APPROVE,
+                    VOTE_DENY);
+            }
+        }
+    }
 
+    // Validates and stores the vote of a custodian already checked by the caller, then updates the proposal state.
+    void dacproposals::apply_vote(proposal_table &proposals, name custodian, name proposal_id, name vote,
+        const custodian_set &custodians, name dac_id) {
         const proposal &prop =
             proposals.get(proposal_id.value, "ERR::VOTEPROP_PROPOSAL_NOT_FOUND::Proposal not found.﻿");
         switch (ProposalState{prop.state.value}) {
@@ -162,95 +208,91 @@ namespace eosdac {
             check(false, "ERR::VOTEPROP_INVALID_PROPOSAL_STATE::Invalid proposal state to accept votes.");
         }
 
-        proposal_vote_table prop_votes(_self, dac_id.value);
-        auto                by_prop_and_voter = prop_votes.get_index<"propandvoter"_n>();
-        uint128_t           joint_id          = combine_ids(proposal_id.value, custodian.value);
-        auto                vote_idx          = by_prop_and_voter.find(joint_id);
-        if (vote_idx == by_prop_and_voter.end()) {
-            prop_votes.emplace(_self, [&](proposalvote &v) {
-                v.vote_id     = prop_votes.available_primary_key();
+        const auto previous = cast_vote(proposal_id, custodian, vote, name{}, dac_id);
+        const auto tally    = update_tally(prop, custodian, previous, custodians, dac_id);
+        update_proposal_state(proposals, prop, tally, dac_id);
+    }
+
+    // Stores the vote or delegation of voter on a proposal and returns the one it replaced, if any.
+    optional<dacproposals::proposal_vote> dacproposals::cast_vote(
+        name proposal_id, name voter, name vote, name delegatee, name dac_id) {
+        auto votes             = proposal_votes_table{get_self(), dac_id.value};
+        auto by_prop_and_voter = votes.get_index<"propandvoter"_n>();
+        auto existing          = by_prop_and_voter.find(combine_ids(proposal_id.value, voter.value));
+        if (existing == by_prop_and_voter.end()) {
+            votes.emplace(get_self(), [&](proposal_vote &v) {
+                v.id          = votes.available_primary_key();
                 v.proposal_id = proposal_id;
-                v.voter       = custodian;
+                v.voter       = voter;
                 v.vote        = vote;
-                v.delegatee   = nullopt;
-            });
-        } else {
-            by_prop_and_voter.modify(vote_idx, _self, [&](proposalvote &v) {
-                v.vote      = vote;
-                v.delegatee = nullopt;
+                v.delegatee   = delegatee;
             });
+            return nullopt;
         }
 
-        updpropvotes(proposal_id, dac_id);
+        const auto previous = *existing;
+        by_prop_and_voter.modify(existing, get_self(), [&](proposal_vote &v) {
+            v.vote      = vote;
+            v.delegatee = delegatee;
+        });
+        return previous;
     }
 
     ACTION dacproposals::delegatevote(name custodian, name proposal_id, name delegatee_custodian, name dac_id) {
         require_auth(custodian);
 
         assertValidMember(custodian, dac_id);
-        check(is_current_custodian(custodian, dac_id), "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
+        const auto custodians = current_custodians(dac_id);
+        check(custodians.contains(custodian), "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
 
         check(custodian != delegatee_custodian, "ERR::DELEGATEVOTE_DELEGATE_SELF::Cannot delegate voting to yourself.");
+        check_votes_migrated(dac_id);
 
         proposal_table proposals(_self, dac_id.value);
 
         const proposal &prop = proposals.get(proposal_id.value, "ERR::PROPOSAL_NOT_FOUND::Proposal not found.");
         check(prop.has_not_expired(), "ERR::PROPOSAL_EXPIRED::Proposal has expired.");
 
-        proposal_vote_table prop_votes(_self, dac_id.value);
-        auto                by_prop_and_voter = prop_votes.get_index<"propandvoter"_n>();
-        uint128_t           joint_id          = combine_ids(proposal_id.value, custodian.value);
-        auto                vote_idx          = by_prop_and_voter.find(joint_id);
-        if (vote_idx == by_prop_and_voter.end()) {
-            prop_votes.emplace(_self, [&](proposalvote &v) {
-                v.vote_id     = prop_votes.available_primary_key();
-                v.proposal_id = proposal_id;
-                v.voter       = custodian;
-                v.vote        = nullopt;
-                v.delegatee   = delegatee_custodian;
-            });
-        } else {
-            by_prop_and_voter.modify(vote_idx, _self, [&](proposalvote &v) {
-                v.vote      = nullopt;
-                v.delegatee = delegatee_custodian;
-            });
-        }
-
-        updpropvotes(proposal_id, dac_id);
+        const auto previous = cast_vote(proposal_id, custodian, name{}, delegatee_custodian, dac_id);
+        const auto tally    = update_tally(prop, custodian, previous, custodians, dac_id);
+        update_proposal_state(proposals, prop, tally, dac_id);
     }
 
     ACTION dacproposals::delegatecat(name custodian, uint64_t category, name delegatee_custodian, name dac_id) {
         require_auth(custodian);
 
         assertValidMember(custodian, dac_id);
-        check(is_current_custodian(custodian, dac_id), "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
+        check(current_custodians(dac_id).contains(custodian),
+            "ERR::VOTEPROP_INVALID_CUSTODIAN::Not a current custodian.");
 
         check(custodian != delegatee_custodian, "ERR::DELEGATEVOTE_DELEGATE_SELF::Cannot delegate voting to yourself.");
+        check_votes_migrated(dac_id);
 
-        proposal_vote_table prop_votes(_self, dac_id.value);
+        category_delegations_table delegations(_self, dac_id.value);
 
-        auto      by_cat_and_voter = prop_votes.get_index<"catandvoter"_n>();
+        auto      by_cat_and_voter = delegations.get_index<"catandvoter"_n>();
         uint128_t joint_id         = combine_ids(category, custodian.value);
         auto      vote_idx         = by_cat_and_voter.find(joint_id);
         if (vote_idx == by_cat_and_voter.end()) {
-            prop_votes.emplace(_self, [&](proposalvote &v) {
-                v.vote_id     = prop_votes.available_primary_key();
-                v.category_id = category;
-                v.voter       = custodian;
-                v.delegatee   = delegatee_custodian;
+            delegations.emplace(_self, [&](category_delegation &d) {
+                d.id        = delegations.available_primary_key();
+                d.category  = category;
+                d.voter     = custodian;
+                d.delegatee = delegatee_custodian;
             });
         } else {
-            by_cat_and_voter.modify(vote_idx, _self, [&](proposalvote &v) {
-                v.delegatee = delegatee_custodian;
+            by_cat_and_voter.modify(vote_idx, _self, [&](category_delegation &d) {
+                d.delegatee = delegatee_custodian;
             });
         }
     }
 
     ACTION dacproposals::undelegateca(name custodian, uint64_t category, name dac_id) {
         require_auth(custodian);
+        check_votes_migrated(dac_id);
 
-        proposal_vote_table prop_votes(_self, dac_id.value);
-        auto                by_cat_and_voter = prop_votes.get_index<"catandvoter"_n>();
+        category_delegations_table delegations(_self, dac_id.value);
+        auto                       by_cat_and_voter = delegations.get_index<"catandvoter"_n>();
 
         uint128_t joint_id = combine_ids(category, custodian.value);
         auto      vote_idx = by_cat_and_voter.find(joint_id);
@@ -304,14 +346,15 @@ namespace eosdac {
         check(
             prop.arbiter_agreed, "ERR::STARTWORK_NO_ARBITER_AGREEMENT::Arbiter has not agreed to be on the proposal.");
 
-        assertValidMember(prop.proposer, dac_id);
+        const auto dac = dacdir::dac_for_id(dac_id);
+        assertValidMember(prop.proposer, dac);
 
         string memo = prop.proposer.to_string() + ":" + proposal_id.to_string() + ":" + prop.content_hash;
 
         time_point_sec time_now = time_point_sec(current_time_point().sec_since_epoch());
 
-        const auto funding_source = dacdir::dac_for_id(dac_id).account_for_type(dacdir::PROP_FUNDS_SOURCE);
-        const auto escrow         = dacdir::dac_for_id(dac_id).account_for_type(dacdir::ESCROW);
+        const auto funding_source = dac.account_for_type(dacdir::PROP_FUNDS_SOURCE);
+        const auto escrow         = dac.account_for_type(dacdir::ESCROW);
 
         check(is_account(funding_source), "ERR::FUNDING_SOURCE_ACCOUNT_NOT_FOUND::Funding account not found");
         check(is_account(escrow), "ERR::ESCROW_ACCOUNT_NOT_FOUND::Escrow account not found");
@@ -367,7 +410,7 @@ namespace eosdac {
 
         int16_t approved_count = count_votes(prop, finalize_approve, dac_id);
 
-        print_f("Worker proposal % for finalizing with: % votes\n", proposal_id.value, approved_count);
+        LOG_DEBUG_F("Worker proposal % for finalizing with: % votes\n", proposal_id.value, approved_count);
 
         check(approved_count >= current_configs.get_finalize_threshold(),
             "ERR::FINALIZE_INSUFFICIENT_VOTES::Insufficient votes on worker proposal to be finalized.");
@@ -377,7 +420,8 @@ namespace eosdac {
 
     ACTION dacproposals::cancelprop(name proposal_id, name dac_id) {
 
-        auto escrow = dacdir::dac_for_id(dac_id).account_for_type(dacdir::ESCROW);
+        const auto dac    = dacdir::dac_for_id(dac_id);
+        auto       escrow = dac.account_for_type(dacdir::ESCROW);
         check(is_account(escrow), "ERR::ESCROW_ACCOUNT_NOT_FOUND::Escrow account not found");
 
         proposal_table  proposals(_self, dac_id.value);
@@ -391,7 +435,7 @@ namespace eosdac {
         check(esc_itr == escrows.end(),
             "ERR::ESCROW_ACTIVE::There should not be an escrow for a proposal. Call cancelwip instead.");
 
-        assertValidMember(prop.proposer, dac_id);
+        assertValidMember(prop.proposer, dac);
         clearprop(prop, dac_id);
     }
 
@@ -404,7 +448,8 @@ namespace eosdac {
                   prop.state == STATE_HAS_ENOUGH_FIN_VOTES,
             "ERR::CANCELWIP_WRONG_STATE::Worker proposal is in the wrong state to be cancelled with cancelwip. Try cancelprop.");
 
-        auto escrow = dacdir::dac_for_id(dac_id).account_for_type(dacdir::ESCROW);
+        const auto dac    = dacdir::dac_for_id(dac_id);
+        auto       escrow = dac.account_for_type(dacdir::ESCROW);
         check(is_account(escrow), "ERR::ESCROW_ACCOUNT_NOT_FOUND::Escrow account not found");
         escrows_table escrows = escrows_table(escrow, dac_id.value);
         auto          esc_itr = escrows.find(proposal_id.value);
@@ -415,13 +460,14 @@ namespace eosdac {
             make_tuple(proposal_id.value, dac_id)) // TODO: Add refund permission to escrw.worlds
             .send();
 
-        assertValidMember(prop.proposer, dac_id);
+        assertValidMember(prop.proposer, dac);
         clearprop(prop, dac_id);
     }
 
     ACTION dacproposals::dispute(name proposal_id, name dac_id) {
         // The escrow should be locked first in a Transaction.
-        auto escrow = dacdir::dac_for_id(dac_id).account_for_type(dacdir::ESCROW);
+        const auto dac    = dacdir::dac_for_id(dac_id);
+        auto       escrow = dac.account_for_type(dacdir::ESCROW);
         check(is_account(escrow), "ERR::ESCROW_ACCOUNT_NOT_FOUND::Escrow account not found");
         escrows_table escrows = escrows_table(escrow, dac_id.value);
         auto          esc_itr = escrows.find(proposal_id.value);
@@ -437,7 +483,7 @@ namespace eosdac {
         const proposal &prop = proposals.get(proposal_id.value, "ERR::PROPOSAL_NOT_FOUND::Proposal not found.");
 
         require_auth(prop.proposer);
-        assertValidMember(prop.proposer, dac_id);
+        assertValidMember(prop.proposer, dac);
         check(prop.state == STATE_PENDING_FINALIZE || prop.state == STATE_HAS_ENOUGH_FIN_VOTES,
             "ERR::DISPUTE_WRONG_STATE::Worker proposal can only be disputed from Pending_finalize state");
 
@@ -449,14 +495,14 @@ namespace eosdac {
     ACTION dacproposals::comment(
         name commenter, name proposal_id, string comment, string comment_category, name dac_id) {
         require_auth(commenter);
-        assertValidMember(commenter, dac_id);
+        const auto dac = dacdir::dac_for_id(dac_id);
+        assertValidMember(commenter, dac);
 
         proposal_table proposals(_self, dac_id.value);
 
         const proposal &prop = proposals.get(proposal_id.value, "ERR::PROPOSAL_NOT_FOUND::Proposal not found.");
         if (!has_auth(prop.proposer)) {
-            auto auth_account = dacdir::dac_for_id(dac_id).owner;
-            require_auth(auth_account);
+            require_auth(dac.owner);
         }
     }
 
@@ -514,7 +560,13 @@ namespace eosdac {
 
         const proposal &prop = proposals.get(proposal_id.value, "ERR::PROPOSAL_NOT_FOUND::Proposal not found.");
 
-        int16_t       approved_count;
+        const auto tally = tally_votes(prop, dac_id);
+        store_tally(tally, dac_id);
+        update_proposal_state(proposals, prop, tally, dac_id);
+    }
+
+    void dacproposals::update_proposal_state(
+        proposal_table &proposals, const proposal &prop, const proposal_tally &tally, name dac_id) {
         ProposalState newPropState;
 
         switch (ProposalState{prop.state.value}) {
@@ -523,19 +575,20 @@ namespace eosdac {
             if (!prop.has_not_expired()) {
                 newPropState = ProposalStateExpired;
             } else {
-                approved_count = count_votes(prop, proposal_approve, dac_id);
-                newPropState   = (approved_count >= configs(get_self(), dac_id).get_proposal_threshold())
-                                     ? ProposalStateHas_enough_approvals_votes
-                                     : ProposalStatePending_approval;
+                const auto threshold = configs(get_self(), dac_id).get_proposal_threshold();
+                newPropState         = (tally.weight_for(VOTE_PROP_APPROVE) >= threshold)
+                                           ? ProposalStateHas_enough_approvals_votes
+                                           : ProposalStatePending_approval;
             }
             break;
         case ProposalStatePending_finalize:
-        case ProposalStateHas_enough_finalize_votes:
-            approved_count = count_votes(prop, finalize_approve, dac_id);
-            newPropState   = (approved_count >= configs(get_self(), dac_id).get_finalize_threshold())
-                                 ? ProposalStateHas_enough_finalize_votes
-                                 : ProposalStatePending_finalize;
+        case ProposalStateHas_enough_finalize_votes: {
+            const auto threshold = configs(get_self(), dac_id).get_finalize_threshold();
+            newPropState         = (tally.weight_for(VOTE_FINAL_APPROVE) >= threshold)
+                                       ? ProposalStateHas_enough_finalize_votes
+                                       : ProposalStatePending_finalize;
             break;
+        }
         default:
             check(false, "ERR::UPDPROPVOTES_WRONG_STATE::Cannot update votes for this proposal state");
         }
@@ -599,26 +652,53 @@ namespace eosdac {
 
         check(prop_to_erase != proposals.end(), "ERR::PROPOSAL_NOT_FOUND::Proposal not found");
 
-        // Remove all the votes associated with that proposal.
-        proposal_vote_table prop_votes(_self, dac_id.value);
-        auto                by_proposal = prop_votes.get_index<"proposal"_n>();
-        auto                itr         = by_proposal.lower_bound(proposal.proposal_id.value);
-        auto                end_itr     = by_proposal.upper_bound(proposal.proposal_id.value);
-        while (itr != end_itr && itr != by_proposal.end() && itr->proposal_id == proposal.proposal_id) {
-            itr = by_proposal.erase(itr);
+        // Remove the first votes associated with that proposal and tombstone it if there are more.
+        if (!erase_votes(proposal.proposal_id, CLEARPROP_VOTE_LIMIT, dac_id)) {
+            tombstones_table{get_self(), dac_id.value}.emplace(get_self(), [&](proposal_tombstone &t) {
+                t.proposal_id = proposal.proposal_id;
+            });
         }
 
+        auto tallies = proposal_tally_table{get_self(), dac_id.value};
+        auto tally   = tallies.find(proposal.proposal_id.value);
+        if (tally != tallies.end()) {
+            tallies.erase(tally);
+        }
+
+        const auto packed = pack(*prop_to_erase);
         eosio::action(eosio::permission_level{get_self(), "notify"_n}, get_self(), "notfyrmv"_n,
-            make_tuple(*prop_to_erase, dac_id))
+            make_tuple(proposal.proposal_id, sha256(packed.data(), packed.size()), dac_id))
             .send();
 
         proposals.erase(prop_to_erase);
     }
 
-    void dacproposals::notfyrmv(const proposal &prop, name dac_id) {
+    // Erases up to limit votes of the proposal and returns whether none are left.
+    bool dacproposals::erase_votes(name proposal_id, uint16_t limit, name dac_id) {
+        proposal_votes_table prop_votes(_self, dac_id.value);
+        auto                 by_proposal = prop_votes.get_index<"propandvoter"_n>();
+        auto                 itr         = by_proposal.lower_bound(combine_ids(proposal_id.value, 0));
+        for (uint16_t erased = 0; erased < limit && itr != by_proposal.end() && itr->proposal_id == proposal_id;
+             erased++) {
+            itr = by_proposal.erase(itr);
+        }
+        return itr == by_proposal.end() || itr->proposal_id != proposal_id;
+    }
+
+    void dacproposals::notfyrmv(name proposal_id, checksum256 content_hash, name dac_id) {
         require_auth(get_self());
     }
 
+    ACTION dacproposals::purgevotes(name proposal_id, uint16_t batch_size, name dac_id) {
+        auto tombstones = tombstones_table{get_self(), dac_id.value};
+        auto tombstone  = tombstones.require_find(
+            proposal_id.value, "ERR::PURGEVOTES_NOT_FOUND::No removed proposal with votes left to purge.");
+
+        if (erase_votes(proposal_id, batch_size, dac_id)) {
+            tombstones.erase(tombstone);
+        }
+    }
+
     ACTION dacproposals::blockprop(name proposal_id, name dac_id) {
         require_auth(get_self());
         proposal_table proposals(_self, dac_id.value);
@@ -630,40 +710,39 @@ namespace eosdac {
     }
 
     int16_t dacproposals::count_votes(proposal prop, VoteType vote_type, name dac_id) {
-        auto custodian_data_src = dacdir::dac_for_id(dac_id).account_for_type(dacdir::CUSTODIAN);
+        return S{tally_votes(prop, dac_id).weight_for(name{vote_type})}.to<int16_t>();
+    }
 
-        print("count votes with account:: ", custodian_data_src, " scope:: ", dac_id);
+    dacproposals::proposal_tally dacproposals::tally_votes(const proposal &prop, name dac_id) {
+        LOG_TRACE("count votes for dac:: ", dac_id);
+        check_votes_migrated(dac_id);
 
-        custodians_table      custodians(custodian_data_src, dac_id.value);
-        std::set<eosio::name> current_custodians;
+        const auto custodians = current_custodians(dac_id);
         // Needed for the category vote fallback to avoid duplicate votes.
         std::set<eosio::name> voted_custodians;
-        for (custodian cust : custodians) {
-            current_custodians.insert(cust.cust_name);
-        }
-        print_f("\ncurrent custodians: ");
-        for (auto name : current_custodians) {
-            print(name, ", ");
+        LOG_TRACE("\ncurrent custodians: ");
+        for (auto name : custodians.custodians) {
+            LOG_TRACE(name, ", ");
         }
 
         // Find the delegated and direct votes for the current proposal
-        proposal_vote_table             prop_votes(_self, dac_id.value);
-        auto                            by_voters = prop_votes.get_index<"proposal"_n>();
-        std::map<eosio::name, uint16_t> delegated_proposal_votes;
-        std::set<eosio::name>           approval_proposal_votes;
+        proposal_votes_table        prop_votes(_self, dac_id.value);
+        auto                        by_voters = prop_votes.get_index<"propandvoter"_n>();
+        auto                        tally     = proposal_tally{prop.proposal_id, custodians.generation};
+        std::map<eosio::name, name> direct_votes;
 
-        auto direct_vote_itr = by_voters.find(prop.proposal_id.value);
+        auto direct_vote_itr = by_voters.lower_bound(combine_ids(prop.proposal_id.value, 0));
 
         // Iterate through all votes on proposal
         while (direct_vote_itr != by_voters.end() && direct_vote_itr->proposal_id == prop.proposal_id) {
             // Check if the voter is a current custodian
-            if (current_custodians.find(direct_vote_itr->voter) != current_custodians.end()) {
+            if (custodians.contains(direct_vote_itr->voter)) {
                 voted_custodians.insert(direct_vote_itr->voter);
-                // Assign vote to either a direct approved vote or a delegated vote.
-                if (direct_vote_itr->delegatee) {
-                    delegated_proposal_votes[direct_vote_itr->delegatee.value()]++;
-                } else if (direct_vote_itr->vote && direct_vote_itr->vote.value() == name{vote_type}) {
-                    approval_proposal_votes.insert(direct_vote_itr->voter);
+                // Assign vote to either a direct vote or a delegated vote.
+                if (direct_vote_itr->is_delegated()) {
+                    tally.add_delegated(direct_vote_itr->delegatee, 1);
+                } else {
+                    direct_votes[direct_vote_itr->voter] = direct_vote_itr->vote;
                 }
                 direct_vote_itr++;
             } else {
@@ -671,67 +750,122 @@ namespace eosdac {
             }
         }
 
-        print_f("\n direct approval_proposal_votes: ");
-        for (auto name : approval_proposal_votes) {
-            print(name, ", ");
-        }
-
-        print_f("\ndelegated_proposal_vote weight: ");
-        for (pair<const eosio::name, unsigned short> entry : delegated_proposal_votes) {
-            print("(name: ", entry.first, " with added weight: ", entry.second, "), ");
+        LOG_TRACE("\n direct votes: ");
+        for (const auto &[voter, vote] : direct_votes) {
+            LOG_TRACE("(name: ", voter, " vote: ", vote, "), ");
         }
 
         // Find matching category votes for the current custodians
 
         // Find the difference between current custodians and the ones that have already voted to avoid double votes.
-        std::vector<name> nonvoting_custodians(current_custodians.size());
-        auto              end_itr = std::set_difference(current_custodians.begin(), current_custodians.end(),
+        std::vector<name> nonvoting_custodians(custodians.custodians.size());
+        auto              end_itr = std::set_difference(custodians.custodians.begin(), custodians.custodians.end(),
                          voted_custodians.begin(), voted_custodians.end(), nonvoting_custodians.begin());
 
         nonvoting_custodians.resize(end_itr - nonvoting_custodians.begin());
 
-        print_f("\ncustodians that have not yet voted: ");
+        LOG_TRACE("\ncustodians that have not yet voted: ");
 
         for (auto name : nonvoting_custodians) {
-            print(name, ", ");
+            LOG_TRACE(name, ", ");
         }
 
-        // Collect category votes from custodians that have not yet voted into a map.
-        auto by_category = prop_votes.get_index<"catandvoter"_n>();
-
-        std::map<eosio::name, uint16_t> category_delegate_votes;
+        // Collect category votes from custodians that have not yet voted.
+        category_delegations_table delegations(_self, dac_id.value);
+        auto                       by_category = delegations.get_index<"catandvoter"_n>();
 
         for (auto custodian : nonvoting_custodians) {
             uint128_t joint_id = combine_ids(prop.category, custodian.value);
             auto      vote_idx = by_category.find(joint_id);
-            if (vote_idx != by_category.end() && vote_idx->category_id && vote_idx->delegatee &&
-                vote_idx->voter == custodian) {
-                category_delegate_votes[vote_idx->delegatee.value()]++;
+            if (vote_idx != by_category.end()) {
+                tally.category_delegations[custodian] = vote_idx->delegatee;
+                tally.add_delegated(vote_idx->delegatee, 1);
             }
         }
 
-        print("\nCategory votes delegated from custodians that have not yet voted for this proposal: ");
-        print("\n( based on the proposal having category: ", prop.category, " )");
-        print("\n( Total should not exceed the number of non voting custodians from the previous step. )\n");
-        for (auto entry : category_delegate_votes) {
-            print("(name: ", entry.first, " vote: ", entry.second, "), ");
+        LOG_TRACE("\nVotes delegated for this proposal or its category: ");
+        LOG_TRACE("\n( based on the proposal having category: ", prop.category, " )\n");
+        for (const auto &[delegatee, count] : tally.delegated) {
+            LOG_TRACE("(name: ", delegatee, " vote: ", count, "), ");
         }
 
         // Tally all the direct + delegated proposal + delegated category vote values
-        print("\n Tally votes:\n");
-        auto approved_count = S{0}.to<int16_t>();
-        for (auto approval : approval_proposal_votes) {
-            const auto addedPropWeight     = delegated_proposal_votes[approval];
-            const auto addedCategoryWeight = category_delegate_votes[approval];
-            const auto weight_to_add =
-                S{1}.to<int16_t>() + S{addedPropWeight}.to<int16_t>() + S{addedCategoryWeight}.to<int16_t>();
-            print("\n\n Approver: ", approval,
-                "   1 "
-                "\n + delegated for proposal: ",
-                addedPropWeight, "\n + delegated for category: ", addedCategoryWeight);
-            approved_count += weight_to_add;
-        }
-        return approved_count;
+        for (const auto &[voter, vote] : direct_votes) {
+            tally.add_weight(vote, int32_t{1} + tally.delegated_to(voter));
+        }
+        return tally;
+    }
+
+    void dacproposals::store_tally(const proposal_tally &tally, name dac_id) {
+        auto tallies  = proposal_tally_table{get_self(), dac_id.value};
+        auto existing = tallies.find(tally.proposal_id.value);
+        if (existing == tallies.end()) {
+            tallies.emplace(get_self(), [&](proposal_tally &t) {
+                t = tally;
+            });
+        } else {
+            tallies.modify(existing, same_payer, [&](proposal_tally &t) {
+                t = tally;
+            });
+        }
+    }
+
+    // Adjusts the stored tally for the vote of a single custodian, previous being their vote row before this action.
+    // The tally is recounted instead if the custodians changed since it was built.
+    dacproposals::proposal_tally dacproposals::update_tally(const proposal &prop, name voter,
+        const optional<proposal_vote> &previous, const custodian_set &custodians, name dac_id) {
+        auto tallies  = proposal_tally_table{get_self(), dac_id.value};
+        auto existing = tallies.find(prop.proposal_id.value);
+        if (existing == tallies.end() || existing->generation != custodians.generation) {
+            // The recount already includes the vote that was just cast.
+            const auto tally = tally_votes(prop, dac_id);
+            store_tally(tally, dac_id);
+            return tally;
+        }
+
+        auto                 tally = *existing;
+        proposal_votes_table prop_votes(_self, dac_id.value);
+        auto                 by_prop_and_voter = prop_votes.get_index<"propandvoter"_n>();
+
+        // A delegated vote only adds weight if the delegatee is a custodian who has voted directly, as in tally_votes.
+        const auto shift_delegated = [&](const name delegatee, const int32_t delta) {
+            tally.add_delegated(delegatee, delta);
+            if (!custodians.contains(delegatee)) {
+                return;
+            }
+            const auto delegatee_vote = by_prop_and_voter.find(combine_ids(prop.proposal_id.value, delegatee.value));
+            if (delegatee_vote != by_prop_and_voter.end() && !delegatee_vote->is_delegated()) {
+                tally.add_weight(delegatee_vote->vote, delta);
+            }
+        };
+
+        const auto own_weight = int32_t{1} + tally.delegated_to(voter);
+
+        // Take back what the custodian counted for before this vote...
+        if (!previous) {
+            const auto category_delegation = tally.category_delegations.find(voter);
+            if (category_delegation != tally.category_delegations.end()) {
+                shift_delegated(category_delegation->second, -1);
+                tally.category_delegations.erase(category_delegation);
+            }
+        } else if (previous->is_delegated()) {
+            shift_delegated(previous->delegatee, -1);
+        } else {
+            tally.add_weight(previous->vote, -own_weight);
+        }
+
+        // ...and count their current vote.
+        const auto &current = by_prop_and_voter.get(combine_ids(prop.proposal_id.value, voter.value));
+        if (current.is_delegated()) {
+            shift_delegated(current.delegatee, 1);
+        } else {
+            tally.add_weight(current.vote, own_weight);
+        }
+
+        tallies.modify(existing, same_payer, [&](proposal_tally &t) {
+            t = tally;
+        });
+        return tally;
     }
 
     void dacproposals::check_proposal_can_start(name proposal_id, name dac_id) {
@@ -745,7 +879,7 @@ namespace eosdac {
 
         int16_t approved_count = count_votes(prop, proposal_approve, dac_id);
 
-        print_f("Worker proposal % to start work with: % votes\n", proposal_id.value, approved_count);
+        LOG_DEBUG_F("Worker proposal % to start work with: % votes\n", proposal_id.value, approved_count);
 
         auto proposal_threshold = configs(get_self(), dac_id).get_proposal_threshold();
         check(approved_count >= proposal_threshold,
@@ -836,6 +970,73 @@ namespace eosdac {
         current_configs.set_min_proposal_duration(new_min_proposal_duration);
     }
 
+    void dacproposals::migratevotes(uint16_t batch_size, name dac_id) {
+        require_auth(get_self());
+        auto legacy_votes = legacy_vote_table{get_self(), dac_id.value};
+        auto itr          = legacy_votes.begin();
+        check(itr != legacy_votes.end(), "ERR::MIGRATEVOTES_NOTHING_TO_MIGRATE::No legacy votes left to migrate.");
+
+        auto votes             = proposal_votes_table{get_self(), dac_id.value};
+        auto by_prop_and_voter = votes.get_index<"propandvoter"_n>();
+        auto delegations       = category_delegations_table{get_self(), dac_id.value};
+        auto by_cat_and_voter  = delegations.get_index<"catandvoter"_n>();
+        auto tallies           = proposal_tally_table{get_self(), dac_id.value};
+        auto proposals         = proposal_table{get_self(), dac_id.value};
+
+        for (uint16_t moved = 0; moved < batch_size && itr != legacy_votes.end(); moved++) {
+            if (itr->proposal_id) {
+                // Votes of a proposal removed in the meantime are dropped, nothing would ever purge them.
+                const auto proposal_id = itr->proposal_id.value();
+                if (proposals.find(proposal_id.value) != proposals.end() &&
+                    by_prop_and_voter.find(combine_ids(proposal_id.value, itr->voter.value)) ==
+                        by_prop_and_voter.end()) {
+                    votes.emplace(get_self(), [&](proposal_vote &v) {
+                        v.id          = votes.available_primary_key();
+                        v.proposal_id = proposal_id;
+                        v.voter       = itr->voter;
+                        v.vote        = itr->vote.value_or(name{});
+                        v.delegatee   = itr->delegatee.value_or(name{});
+                    });
+                }
+                // The tally may hold this vote without the new table knowing it, so count it again next time.
+                const auto tally = tallies.find(proposal_id.value);
+                if (tally != tallies.end()) {
+                    tallies.erase(tally);
+                }
+            } else if (itr->category_id && itr->delegatee &&
+                       by_cat_and_voter.find(combine_ids(itr->category_id.value(), itr->voter.value)) ==
+                           by_cat_and_voter.end()) {
+                delegations.emplace(get_self(), [&](category_delegation &d) {
+                    d.id        = delegations.available_primary_key();
+                    d.category  = itr->category_id.value();
+                    d.voter     = itr->voter;
+                    d.delegatee = itr->delegatee.value();
+                });
+            }
+            itr = legacy_votes.erase(itr);
+        }
+    }
+
+    // Votes are only read from propvotes2 and catdelegs, so nothing may read or cast them while legacy rows are left.
+    void dacproposals::check_votes_migrated(name dac_id) {
+        const auto legacy_votes = legacy_vote_table{get_self(), dac_id.value};
+        check(legacy_votes.begin() == legacy_votes.end(),
+            "ERR::VOTES_NOT_MIGRATED::Votes must be migrated with migratevotes first.");
+    }
+
+#ifdef IS_DEV
+    void dacproposals::addlegvotes(vector<proposalvote> votes, name dac_id) {
+        require_auth(get_self());
+        auto legacy_votes = legacy_vote_table{get_self(), dac_id.value};
+        for (const auto &vote : votes) {
+            legacy_votes.emplace(get_self(), [&](proposalvote &v) {
+                v         = vote;
+                v.vote_id = legacy_votes.available_primary_key();
+            });
+        }
+    }
+#endif
+
     void dacproposals::addarbwl(name arbiter, uint64_t rating, name dac_id) {
         require_auth(get_self());
         auto arbiterwhitelist = arbiterwhitelist_table(get_self(), dac_id.value);
@@ -1,4 +1,5 @@
 #include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/ignore.hpp>
 #include <eosio/singleton.hpp>
@@ -33,6 +34,9 @@ namespace eosdac {
     static constexpr eosio::name STATE_COMPLETED{"completed"};
     static constexpr eosio::name STATE_BLOCKED{"blocked"};
 
+    // Votes erased along with a removed proposal, any further ones are left for purgevotes.
+    static constexpr uint16_t CLEARPROP_VOTE_LIMIT = 25;
+
     CONTRACT dacproposals : public contract {
         enum VoteTypePublic : uint64_t {
             vote_abstain = VOTE_ABSTAIN.value,
@@ -252,6 +256,24 @@ namespace eosdac {
          */
         ACTION votepropfin(name custodian, name proposal_id, name vote, name dac_id);
 
+        /**
+         * @brief Custodian votes on several proposals at once
+         *
+         * Checks the custodian once and then applies each vote as voteprop or
+         * votepropfin would, depending on whether the proposal is waiting for
+         * approval or for finalization. The state of each proposal is updated
+         * once, so a proposal may only appear once in the list.
+         *
+         * @param custodian The custodian casting the votes
+         * @param votes Pairs of proposal id and vote type: 'approve', 'deny', or 'abstain'
+         * @param dac_id The DAC scope identifier
+         *
+         * @pre Caller must be the custodian account
+         * @pre Custodian must be a current active custodian
+         * @pre Each proposal must accept votes as for voteprop or votepropfin
+         */
+        ACTION votepropmany(name custodian, vector<pair<name, name>> votes, name dac_id);
+
         /**
          * @brief Delegates voting power for a specific proposal to another custodian
          *
@@ -579,6 +601,8 @@ namespace eosdac {
          * This action recalculates and updates the vote counts for a proposal,
          * including direct votes and delegated votes. It also updates the proposal
          * state based on current vote tallies and thresholds.
+         * Votes only adjust the stored tally, so this is the way to pick up changes
+         * to the custodians or category delegations before startwork or finalize.
          *
          * @param proposal_id The proposal identifier
          * @param dac_id The DAC scope identifier
@@ -726,13 +750,33 @@ namespace eosdac {
          *
          * This action is called internally when a proposal is removed from the
          * contract to provide notification hooks for external systems or logging.
+         * It only carries the id and the sha256 of the packed proposal row, so the
+         * size of the notification does not depend on the proposal.
          *
-         * @param prop The proposal being removed
+         * @param proposal_id The identifier of the proposal being removed
+         * @param content_hash The sha256 of the proposal row as it was removed
          * @param dac_id The DAC scope identifier
          *
          * @pre Caller must be the contract itself
          */
-        ACTION notfyrmv(const proposal &prop, name dac_id);
+        ACTION notfyrmv(name proposal_id, checksum256 content_hash, name dac_id);
+
+        /**
+         * @brief Erases the remaining votes of a removed proposal
+         *
+         * Removing a proposal only erases its first votes so that cancelprop, cancelwip,
+         * rmvcompleted and clearexpprop stay cheap. If more are left the proposal is
+         * tombstoned and this action erases up to batch_size of them per call, starting
+         * from the first vote left. It can be called by anyone, and the proposal id can
+         * be used again once all the votes have been purged.
+         *
+         * @param proposal_id The identifier of the removed proposal
+         * @param batch_size The maximum number of votes to erase
+         * @param dac_id The DAC scope identifier
+         *
+         * @pre The proposal must have been removed with votes left to purge
+         */
+        ACTION purgevotes(name proposal_id, uint16_t batch_size, name dac_id);
 
         /**
          * @brief Blocks a proposal from further processing
@@ -780,15 +824,35 @@ namespace eosdac {
          */
         ACTION minduration(uint32_t new_min_proposal_duration, name dac_id);
 
-      private:
-        void    clearprop(const proposal &proposal, name dac_id);
-        void    transferfunds(const proposal &prop, name dac_id);
-        void    check_proposal_can_start(name proposal_id, name dac_id);
-        int16_t count_votes(proposal prop, VoteType vote_type, name dac_id);
-        void    arbiter_rule_on_proposal(name arbiter, name proposal_id, name dac_id);
-        void    _voteprop(name custodian, name proposal_id, name vote, name dac_id);
-        bool    is_current_custodian(name custodian, name dac_id);
+        /**
+         * @brief Moves rows from the legacy propvotes table into propvotes2 and catdelegs
+         *
+         * Proposal votes and category delegations used to share the propvotes table. This
+         * action moves up to batch_size of those rows into their own tables and erases them
+         * from propvotes. It needs to be called for every DAC after deployment until there
+         * is nothing left to migrate. Until then creating proposals, voting, delegating and
+         * counting votes fail. Rows for which a newer vote or delegation exists, or whose
+         * proposal has been removed, are dropped. The tally of every proposal touched is
+         * discarded so it is recounted on the next vote.
+         *
+         * @param batch_size The maximum number of legacy rows to move
+         * @param dac_id The DAC scope identifier
+         *
+         * @pre Caller must be the contract itself
+         * @pre There must be legacy rows left to migrate
+         */
+        ACTION migratevotes(uint16_t batch_size, name dac_id);
 
+      private:
+        void          clearprop(const proposal &proposal, name dac_id);
+        void          transferfunds(const proposal &prop, name dac_id);
+        void          check_proposal_can_start(name proposal_id, name dac_id);
+        int16_t       count_votes(proposal prop, VoteType vote_type, name dac_id);
+        void          arbiter_rule_on_proposal(name arbiter, name proposal_id, name dac_id);
+        void          _voteprop(name custodian, name proposal_id, name vote, name dac_id);
+        custodian_set current_custodians(name dac_id);
+
+        // Superseded by propvotes2 and catdelegs, kept until migratevotes has moved all the rows out of it.
         TABLE proposalvote {
             uint64_t           vote_id;
             name               voter;
@@ -821,7 +885,7 @@ namespace eosdac {
             EOSLIB_SERIALIZE(proposalvote, (vote_id)(voter)(proposal_id)(category_id)(vote)(delegatee)(comment_hash))
         };
 
-        using proposal_vote_table = eosio::multi_index<"propvotes"_n, proposalvote,
+        using legacy_vote_table = eosio::multi_index<"propvotes"_n, proposalvote,
             indexed_by<"voter"_n, eosio::const_mem_fun<proposalvote, uint64_t, &proposalvote::voter_key>>,
             indexed_by<"proposal"_n, eosio::const_mem_fun<proposalvote, uint64_t, &proposalvote::proposal_key>>,
             indexed_by<"category"_n, eosio::const_mem_fun<proposalvote, uint64_t, &proposalvote::category_key>>,
@@ -829,5 +893,131 @@ namespace eosdac {
                 eosio::const_mem_fun<proposalvote, uint128_t, &proposalvote::get_prop_and_voter>>,
             indexed_by<"catandvoter"_n,
                 eosio::const_mem_fun<proposalvote, uint128_t, &proposalvote::get_category_and_voter>>>;
+
+        void check_votes_migrated(name dac_id);
+
+#ifdef IS_DEV
+      public:
+        // Writes rows in the legacy propvotes format so migratevotes can be tested
+        ACTION addlegvotes(vector<proposalvote> votes, name dac_id);
+
+      private:
+#endif
+
+        // A custodian's vote on a proposal, or the custodian they delegated it to. The vote only counts while
+        // delegatee is empty, an empty vote being an abstention. Primary keys are limited to 64 bits so the rows are
+        // found through the proposal x voter index, which is ordered by proposal first.
+        TABLE proposal_vote {
+            uint64_t id;
+            name     proposal_id;
+            name     voter;
+            name     vote;
+            name     delegatee;
+
+            uint64_t primary_key() const {
+                return id;
+            }
+            uint128_t by_prop_and_voter() const {
+                return combine_ids(proposal_id.value, voter.value);
+            }
+            bool is_delegated() const {
+                return delegatee.value != 0;
+            }
+        };
+
+        using proposal_votes_table = eosio::multi_index<"propvotes2"_n, proposal_vote,
+            indexed_by<"propandvoter"_n,
+                eosio::const_mem_fun<proposal_vote, uint128_t, &proposal_vote::by_prop_and_voter>>>;
+
+        // A custodian delegating their vote on every proposal of a category.
+        TABLE category_delegation {
+            uint64_t id;
+            uint64_t category;
+            name     voter;
+            name     delegatee;
+
+            uint64_t primary_key() const {
+                return id;
+            }
+            uint128_t by_cat_and_voter() const {
+                return combine_ids(category, voter.value);
+            }
+        };
+
+        using category_delegations_table = eosio::multi_index<"catdelegs"_n, category_delegation,
+            indexed_by<"catandvoter"_n,
+                eosio::const_mem_fun<category_delegation, uint128_t, &category_delegation::by_cat_and_voter>>>;
+
+        optional<proposal_vote> cast_vote(name proposal_id, name voter, name vote, name delegatee, name dac_id);
+
+        // Running vote weights of a proposal so a vote does not need to recount all the others. It is built by a full
+        // recount the first time a proposal is voted on or when updpropvotes is called, and then adjusted for each
+        // vote, unless the custodian set changed in the meantime. Changes to category delegations are only picked up by
+        // the next recount, which startwork and finalize always do before checking their thresholds.
+        TABLE proposal_tally {
+            name                proposal_id;
+            uint64_t            generation;           // of the custodian set the tally was counted for
+            map<name, uint16_t> weights;              // vote -> custodians casting it plus the votes delegated to them
+            map<name, uint16_t> delegated;            // custodian -> votes delegated to them for this proposal
+            map<name, name>     category_delegations; // custodians without a vote counted through their category
+
+            uint64_t primary_key() const {
+                return proposal_id.value;
+            }
+
+            uint16_t weight_for(const name vote) const {
+                const auto itr = weights.find(vote);
+                return itr != weights.end() ? itr->second : 0;
+            }
+
+            uint16_t delegated_to(const name custodian) const {
+                const auto itr = delegated.find(custodian);
+                return itr != delegated.end() ? itr->second : 0;
+            }
+
+            void add_weight(const name vote, const int32_t delta) {
+                add_count(weights, vote, delta);
+            }
+
+            void add_delegated(const name custodian, const int32_t delta) {
+                add_count(delegated, custodian, delta);
+            }
+
+            static void add_count(map<name, uint16_t> &counts, const name key, const int32_t delta) {
+                const auto itr   = counts.find(key);
+                const auto count = S{int32_t{itr != counts.end() ? itr->second : uint16_t{}}} + S{delta};
+                if (count == 0) {
+                    if (itr != counts.end()) {
+                        counts.erase(itr);
+                    }
+                } else {
+                    counts[key] = count.to<uint16_t>();
+                }
+            }
+        };
+
+        using proposal_tally_table = eosio::multi_index<"proptallies"_n, proposal_tally>;
+
+        // A removed proposal with votes left for purgevotes. Its id cannot be used again until they are gone.
+        TABLE proposal_tombstone {
+            name proposal_id;
+
+            uint64_t primary_key() const {
+                return proposal_id.value;
+            }
+        };
+
+        using tombstones_table = eosio::multi_index<"proptombs"_n, proposal_tombstone>;
+
+        bool erase_votes(name proposal_id, uint16_t limit, name dac_id);
+
+        proposal_tally tally_votes(const proposal &prop, name dac_id);
+        void           store_tally(const proposal_tally &tally, name dac_id);
+        proposal_tally update_tally(const proposal &prop, name voter, const optional<proposal_vote> &previous,
+            const custodian_set &custodians, name dac_id);
+        void update_proposal_state(
+            proposal_table &proposals, const proposal &prop, const proposal_tally &tally, name dac_id);
+        void apply_vote(proposal_table &proposals, name custodian, name proposal_id, name vote,
+            const custodian_set &custodians, name dac_id);
     };
 } // namespace eosdac
@@ -925,6 +925,55 @@ describe('Dacproposals', () => {
               }
             );
           });
+          it('should only count the latest vote in the tally', async () => {
+            const res = await shared.dacproposals_contract.proptalliesTable({
+              scope: dacId,
+              lowerBound: newpropid,
+              upperBound: newpropid,
+            });
+            chai
+              .expect(res.rows[0].weights)
+              .to.deep.equal([{ key: 'propdeny', value: 1 }]);
+          });
+        });
+        context('votepropmany', async () => {
+          it('should fail with a proposal listed twice', async () => {
+            await assertEOSErrorIncludesMessage(
+              shared.dacproposals_contract.votepropmany(
+                propDacCustodians[0].name,
+                [
+                  { first: newpropid, second: VoteType.vote_deny },
+                  { first: newpropid, second: VoteType.vote_approve },
+                ],
+                dacId,
+                { from: propDacCustodians[0] }
+              ),
+              'ERR::VOTEPROPMANY_DUPLICATE_PROPOSAL'
+            );
+          });
+          it('should succeed', async () => {
+            await shared.dacproposals_contract.votepropmany(
+              propDacCustodians[0].name,
+              [
+                { first: newpropid, second: VoteType.vote_deny },
+                { first: otherfoundpropid, second: VoteType.vote_approve },
+              ],
+              dacId,
+              { from: propDacCustodians[0] }
+            );
+          });
+          it('should have stored a vote for each proposal', async () => {
+            const votes = [
+              ...(await proposalVotes(dacId, newpropid)),
+              ...(await proposalVotes(dacId, otherfoundpropid)),
+            ].filter((v) => v.voter == propDacCustodians[0].name);
+            chai
+              .expect(votes.map((v) => [v.proposal_id, v.vote]))
+              .to.have.deep.members([
+                [newpropid, 'propdeny'],
+                [otherfoundpropid, 'propapprove'],
+              ]);
+          });
         });
       });
     });
@@ -1574,16 +1623,9 @@ describe('Dacproposals', () => {
       });
       context('clear expired proposals', async () => {
         it('should have the 1 of votes before clearing for the proposal', async () => {
-          await assertRowCount(
-            shared.dacproposals_contract.propvotesTable({
-              scope: dacId,
-              indexPosition: 3,
-              keyType: 'i64',
-              lowerBound: propId,
-              upperBound: propId,
-            }),
-            1
-          );
+          chai
+            .expect(await proposalVotes(dacId, propId))
+            .to.have.lengthOf(1);
         });
         it('should have a proposal record before clearing', async () => {
           await assertRowCount(
@@ -1620,16 +1662,9 @@ describe('Dacproposals', () => {
             );
           });
           it('should remove the related votes for the proposal', async () => {
-            await assertRowCount(
-              shared.dacproposals_contract.propvotesTable({
-                scope: dacId,
-                indexPosition: 3,
-                keyType: 'i64',
-                lowerBound: propId,
-                upperBound: propId,
-              }),
-              0
-            );
+            chai
+              .expect(await proposalVotes(dacId, propId))
+              .to.have.lengthOf(0);
           });
         });
       });
@@ -2742,14 +2777,9 @@ describe('Dacproposals', () => {
             );
           });
           it('should contain initial votes for proposal', async () => {
-            const result = await shared.dacproposals_contract.propvotesTable({
-              scope: dacId,
-              indexPosition: 3,
-              keyType: 'i64',
-              lowerBound: cancelpropid,
-              upperBound: cancelpropid,
-            });
-            chai.expect(result.rows.length).equal(proposeApproveTheshold);
+            chai
+              .expect(await proposalVotes(dacId, cancelpropid))
+              .to.have.lengthOf(proposeApproveTheshold);
           });
           it('cancelprop should fail with active escrow error', async () => {
             await assertEOSErrorIncludesMessage(
@@ -2775,16 +2805,9 @@ describe('Dacproposals', () => {
             );
           });
           it('should not contain initial votes for proposal', async () => {
-            await assertRowCount(
-              shared.dacproposals_contract.propvotesTable({
-                scope: dacId,
-                indexPosition: 3,
-                keyType: 'i64',
-                lowerBound: cancelpropid,
-                upperBound: cancelpropid,
-              }),
-              0
-            );
+            chai
+              .expect(await proposalVotes(dacId, cancelpropid))
+              .to.have.lengthOf(0);
           });
           it('escrow table should contain expected rows', async () => {
             // After cancelwip, the escrow for this proposal should be removed
@@ -2850,16 +2873,9 @@ describe('Dacproposals', () => {
       });
 
       it('should remove all votes for the proposal', async () => {
-        await assertRowCount(
-          shared.dacproposals_contract.propvotesTable({
-            scope: dacId,
-            indexPosition: 3,
-            keyType: 'i64',
-            lowerBound: finvotespropid,
-            upperBound: finvotespropid,
-          }),
-          0
-        );
+        chai
+          .expect(await proposalVotes(dacId, finvotespropid))
+          .to.have.lengthOf(0);
       });
     });
   });
@@ -2955,16 +2971,9 @@ describe('Dacproposals', () => {
             );
           });
           it('should not contain initial votes for proposal', async () => {
-            await assertRowCount(
-              shared.dacproposals_contract.propvotesTable({
-                scope: dacId,
-                indexPosition: 3,
-                keyType: 'i64',
-                lowerBound: cancelpropid,
-                upperBound: cancelpropid,
-              }),
-              0
-            );
+            chai
+              .expect(await proposalVotes(dacId, cancelpropid))
+              .to.have.lengthOf(0);
           });
           it('escrow table should contain expected rows', async () => {
             await assertRowCount(
@@ -3317,16 +3326,9 @@ describe('Dacproposals', () => {
               );
             });
             it('propvotes should contain 3 votes for this proposal - one as a delegated vote', async () => {
-              await assertRowCount(
-                shared.dacproposals_contract.propvotesTable({
-                  scope: dacId,
-                  indexPosition: 3,
-                  keyType: 'i64',
-                  lowerBound: propId,
-                  upperBound: propId,
-                }),
-                3
-              );
+              chai
+                .expect(await proposalVotes(dacId, propId))
+                .to.have.lengthOf(3);
             });
           }
         );
@@ -3356,16 +3358,9 @@ describe('Dacproposals', () => {
           );
         });
         it('should contain the delegated category votes', async () => {
-          await assertRowCount(
-            shared.dacproposals_contract.propvotesTable({
-              scope: dacId,
-              indexPosition: 4,
-              keyType: 'i64',
-              lowerBound: category,
-              upperBound: category,
-            }),
-            3
-          );
+          chai
+            .expect(await categoryDelegations(dacId, category))
+            .to.have.lengthOf(3);
         });
       });
     });
@@ -3390,22 +3385,433 @@ describe('Dacproposals', () => {
         );
       });
       it('should have removed the delegated category votes', async () => {
-        await assertRowCount(
-          shared.dacproposals_contract.propvotesTable({
-            scope: dacId,
-            indexPosition: 4,
-            keyType: 'i64',
-            lowerBound: category,
-            upperBound: category,
-          }),
-          2
-        );
+        chai
+          .expect(await categoryDelegations(dacId, category))
+          .to.have.lengthOf(2);
       });
       it('should succeed setting up testuser', async () => {
         await setup_test_user(propDacCustodians[0], 'PROPDAC');
       });
     });
   });
+  context('running tally', async () => {
+    const propId = 'tallyprop';
+    const tallyCategory = 55;
+    const asCustodian = (custodian: Account) => ({
+      auths: [
+        { actor: custodian.name, permission: 'active' },
+        { actor: shared.auth_account.name, permission: 'active' },
+      ],
+    });
+    const storedTally = async () =>
+      (
+        await shared.dacproposals_contract.proptalliesTable({
+          scope: dacId,
+          lowerBound: propId,
+          upperBound: propId,
+        })
+      ).rows[0];
+    let incremental: any;
+    before(async () => {
+      await shared.dacproposals_contract.updateconfig(
+        {
+          proposal_threshold: proposeApproveTheshold,
+          finalize_threshold: 5,
+          approval_duration: 130,
+          proposal_fee: {
+            quantity: '0.0000 PROPDAC',
+            contract: shared.dac_token_contract.name,
+          },
+          min_proposal_duration: 0,
+        },
+        dacId,
+        { from: shared.dacproposals_contract.account }
+      );
+      await shared.dacproposals_contract.createprop(
+        proposer1Account.name,
+        'running tally_title',
+        'running tally_summary',
+        arbiter.name,
+        { quantity: '106.0000 EOS', contract: 'eosio.token' },
+        {
+          quantity: '10.0000 PROPDAC',
+          contract: shared.dac_token_contract.name,
+        },
+        'asdfasdfasdfasdfasdfasdfajjhjhjsdffdsa',
+        propId,
+        tallyCategory,
+        130,
+        dacId,
+        { from: proposer1Account }
+      );
+      const [c0, c1, c2, c3] = propDacCustodians;
+      const contract = shared.dacproposals_contract;
+      await contract.delegatecat(
+        c3.name,
+        tallyCategory,
+        c0.name,
+        dacId,
+        asCustodian(c3)
+      );
+      await contract.voteprop(
+        c0.name,
+        propId,
+        VoteType.vote_approve,
+        dacId,
+        asCustodian(c0)
+      );
+      await contract.delegatevote(
+        c1.name,
+        propId,
+        c0.name,
+        dacId,
+        asCustodian(c1)
+      );
+      await contract.delegatevote(
+        c2.name,
+        propId,
+        c1.name,
+        dacId,
+        asCustodian(c2)
+      );
+      await contract.voteprop(
+        c1.name,
+        propId,
+        VoteType.vote_deny,
+        dacId,
+        asCustodian(c1)
+      );
+      await contract.voteprop(
+        c3.name,
+        propId,
+        VoteType.vote_approve,
+        dacId,
+        asCustodian(c3)
+      );
+      await contract.voteprop(
+        c0.name,
+        propId,
+        VoteType.vote_deny,
+        dacId,
+        asCustodian(c0)
+      );
+      await contract.undelegateca(
+        c3.name,
+        tallyCategory,
+        dacId,
+        asCustodian(c3)
+      );
+      incremental = await storedTally();
+    });
+    it('should have adjusted the tally for each vote', async () => {
+      chai.expect(incremental.weights).to.deep.equal([
+        { key: 'propapprove', value: 1 },
+        { key: 'propdeny', value: 3 },
+      ]);
+    });
+    it('should match a full recount', async () => {
+      await shared.dacproposals_contract.updpropvotes(propId, dacId, {
+        auths: [
+          { actor: proposer1Account.name, permission: 'active' },
+          { actor: shared.auth_account.name, permission: 'active' },
+        ],
+      });
+      chai.expect(await storedTally()).to.deep.equal(incremental);
+    });
+  });
+  context('purgevotes', async () => {
+    const propId = 'purgeprop';
+    const voteCount = 30;
+    const createPurgeProp = () =>
+      shared.dacproposals_contract.createprop(
+        proposer1Account.name,
+        'purge votes_title',
+        'purge votes_summary',
+        arbiter.name,
+        { quantity: '106.0000 EOS', contract: 'eosio.token' },
+        {
+          quantity: '10.0000 PROPDAC',
+          contract: shared.dac_token_contract.name,
+        },
+        'asdfasdfasdfasdfasdfasdfajjhjhjsdffdsa',
+        propId,
+        category,
+        130,
+        dacId,
+        { from: proposer1Account }
+      );
+    const tombstones = () =>
+      shared.dacproposals_contract.proptombsTable({
+        scope: dacId,
+        lowerBound: propId,
+        upperBound: propId,
+      });
+    before(async () => {
+      await shared.dacproposals_contract.updateconfig(
+        {
+          proposal_threshold: proposeApproveTheshold,
+          finalize_threshold: 5,
+          approval_duration: 130,
+          proposal_fee: {
+            quantity: '0.0000 PROPDAC',
+            contract: shared.dac_token_contract.name,
+          },
+          min_proposal_duration: 0,
+        },
+        dacId,
+        { from: shared.dacproposals_contract.account }
+      );
+      await createPurgeProp();
+      // Only custodians can vote, so load the votes through the legacy table
+      const letters = 'abcdefghijklmnopqrstuvwxyz';
+      const votes = [...Array(voteCount).keys()].map((i) => ({
+        vote_id: 0,
+        voter: `pvoter${letters[i % 26]}${letters[Math.floor(i / 26)]}`,
+        proposal_id: propId,
+        category_id: null,
+        vote: 'propapprove',
+        delegatee: null,
+        comment_hash: null,
+      }));
+      await shared.dacproposals_contract.addlegvotes(votes, dacId, {
+        from: shared.dacproposals_contract.account,
+      });
+      await shared.dacproposals_contract.migratevotes(voteCount, dacId, {
+        from: shared.dacproposals_contract.account,
+      });
+    });
+    it('should fail for a proposal without votes left to purge', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.dacproposals_contract.purgevotes(newpropid, 10, dacId, {
+          from: otherAccount,
+        }),
+        'ERR::PURGEVOTES_NOT_FOUND'
+      );
+    });
+    it('should have all the votes before removing the proposal', async () => {
+      chai
+        .expect(await proposalVotes(dacId, propId))
+        .to.have.lengthOf(voteCount);
+    });
+    it('should erase only the first votes when the proposal is removed', async () => {
+      await shared.dacproposals_contract.cancelprop(propId, dacId, {
+        from: proposer1Account,
+      });
+      chai
+        .expect(await proposalVotes(dacId, propId))
+        .to.have.lengthOf(voteCount - 25);
+    });
+    it('should tombstone the proposal', async () => {
+      await assertRowCount(tombstones(), 1);
+    });
+    it('should not allow the id to be used again', async () => {
+      await assertEOSErrorIncludesMessage(
+        createPurgeProp(),
+        'ERR::CREATEPROP_ID_NOT_PURGED'
+      );
+    });
+    it('should purge a batch and keep the tombstone', async () => {
+      await shared.dacproposals_contract.purgevotes(propId, 3, dacId, {
+        from: otherAccount,
+      });
+      chai
+        .expect(await proposalVotes(dacId, propId))
+        .to.have.lengthOf(voteCount - 25 - 3);
+      await assertRowCount(tombstones(), 1);
+    });
+    it('should purge the rest and drop the tombstone', async () => {
+      await shared.dacproposals_contract.purgevotes(propId, 10, dacId, {
+        from: otherAccount,
+      });
+      chai.expect(await proposalVotes(dacId, propId)).to.have.lengthOf(0);
+      await assertRowCount(tombstones(), 0);
+    });
+    it('should allow the id to be used again', async () => {
+      await createPurgeProp();
+      chai.expect(await proposalVotes(dacId, propId)).to.have.lengthOf(0);
+    });
+  });
+  context('migratevotes', async () => {
+    const propId = 'migrateprop';
+    const legacyCategory = 77;
+    const legacyVote = (
+      voter: Account,
+      proposal_id: string | null,
+      category_id: number | null,
+      vote: string | null,
+      delegatee: Account | null
+    ) => ({
+      vote_id: 0,
+      voter: voter.name,
+      proposal_id,
+      category_id,
+      vote,
+      delegatee: delegatee ? delegatee.name : null,
+      comment_hash: null,
+    });
+    before(async () => {
+      await shared.dacproposals_contract.updateconfig(
+        {
+          proposal_threshold: proposeApproveTheshold,
+          finalize_threshold: 5,
+          approval_duration: 130,
+          proposal_fee: {
+            quantity: '0.0000 PROPDAC',
+            contract: shared.dac_token_contract.name,
+          },
+          min_proposal_duration: 0,
+        },
+        dacId,
+        { from: shared.dacproposals_contract.account }
+      );
+      await shared.dacproposals_contract.createprop(
+        proposer1Account.name,
+        'migrate votes_title',
+        'migrate votes_summary',
+        arbiter.name,
+        { quantity: '106.0000 EOS', contract: 'eosio.token' },
+        {
+          quantity: '10.0000 PROPDAC',
+          contract: shared.dac_token_contract.name,
+        },
+        'asdfasdfasdfasdfasdfasdfajjhjhjsdffdsa',
+        propId,
+        category,
+        130,
+        dacId,
+        { from: proposer1Account }
+      );
+      await shared.dacproposals_contract.addlegvotes(
+        [
+          legacyVote(propDacCustodians[0], propId, null, 'propapprove', null),
+          legacyVote(propDacCustodians[1], propId, null, 'propapprove', null),
+          legacyVote(propDacCustodians[2], propId, null, 'propapprove', null),
+          legacyVote(
+            propDacCustodians[3],
+            propId,
+            null,
+            null,
+            propDacCustodians[0]
+          ),
+          legacyVote(
+            propDacCustodians[0],
+            'goneprop',
+            null,
+            'propapprove',
+            null
+          ),
+          legacyVote(
+            propDacCustodians[1],
+            null,
+            legacyCategory,
+            null,
+            propDacCustodians[2]
+          ),
+        ],
+        dacId,
+        { from: shared.dacproposals_contract.account }
+      );
+    });
+    it('should not accept votes before the migration', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.dacproposals_contract.voteprop(
+          propDacCustodians[4].name,
+          propId,
+          VoteType.vote_approve,
+          dacId,
+          {
+            auths: [
+              { actor: propDacCustodians[4].name, permission: 'active' },
+              { actor: shared.auth_account.name, permission: 'active' },
+            ],
+          }
+        ),
+        'ERR::VOTES_NOT_MIGRATED'
+      );
+    });
+    it('should not count votes before the migration', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.dacproposals_contract.updpropvotes(propId, dacId, {
+          auths: [
+            { actor: proposer1Account.name, permission: 'active' },
+            { actor: shared.auth_account.name, permission: 'active' },
+          ],
+        }),
+        'ERR::VOTES_NOT_MIGRATED'
+      );
+    });
+    it('should migrate a first batch', async () => {
+      await shared.dacproposals_contract.migratevotes(2, dacId, {
+        from: shared.dacproposals_contract.account,
+      });
+      await assertRowCount(
+        shared.dacproposals_contract.propvotesTable({ scope: dacId }),
+        4
+      );
+    });
+    it('should migrate the rest', async () => {
+      await shared.dacproposals_contract.migratevotes(10, dacId, {
+        from: shared.dacproposals_contract.account,
+      });
+      await assertRowCount(
+        shared.dacproposals_contract.propvotesTable({ scope: dacId }),
+        0
+      );
+    });
+    it('should have moved the votes of the proposal', async () => {
+      const votes = await proposalVotes(dacId, propId);
+      chai
+        .expect(votes.map((v) => [v.voter, v.vote, v.delegatee]))
+        .to.have.deep.members([
+          [propDacCustodians[0].name, 'propapprove', ''],
+          [propDacCustodians[1].name, 'propapprove', ''],
+          [propDacCustodians[2].name, 'propapprove', ''],
+          [propDacCustodians[3].name, '', propDacCustodians[0].name],
+        ]);
+    });
+    it('should have dropped the votes of a removed proposal', async () => {
+      chai.expect(await proposalVotes(dacId, 'goneprop')).to.have.lengthOf(0);
+    });
+    it('should have moved the category delegation', async () => {
+      const delegations = await categoryDelegations(dacId, legacyCategory);
+      chai
+        .expect(delegations.map((d) => [d.voter, d.delegatee]))
+        .to.deep.equal([
+          [propDacCustodians[1].name, propDacCustodians[2].name],
+        ]);
+    });
+    it('should count the migrated votes', async () => {
+      await shared.dacproposals_contract.updpropvotes(propId, dacId, {
+        auths: [
+          { actor: proposer1Account.name, permission: 'active' },
+          { actor: shared.auth_account.name, permission: 'active' },
+        ],
+      });
+      const res = await shared.dacproposals_contract.proposalsTable({
+        scope: dacId,
+        lowerBound: propId,
+        upperBound: propId,
+      });
+      chai.expect(res.rows[0].state).to.equal(
+        ProposalState.ProposalStateHas_enough_approvals_votes
+      );
+    });
+    it('should fail without contract auth', async () => {
+      await assertMissingAuthority(
+        shared.dacproposals_contract.migratevotes(10, dacId, {
+          from: proposer1Account,
+        })
+      );
+    });
+    it('should fail when there are no legacy votes left', async () => {
+      await assertEOSErrorIncludesMessage(
+        shared.dacproposals_contract.migratevotes(10, dacId, {
+          from: shared.dacproposals_contract.account,
+        }),
+        'ERR::MIGRATEVOTES_NOTHING_TO_MIGRATE'
+      );
+    });
+  });
   context('blockprop', async () => {
     const test_proposal_id = 'blockpropid';
 
@@ -3664,3 +4070,20 @@ async function setup_permissions() {
     shared.dacproposals_contract.account
   );
 }
+
+// Votes and delegations are found through 128 bit indexes, so fetch the scope and filter here.
+async function proposalVotes(dacId: string, proposalId: string) {
+  const res = await shared.dacproposals_contract.propvotes2Table({
+    scope: dacId,
+    limit: 1000,
+  });
+  return res.rows.filter((v) => v.proposal_id == proposalId);
+}
+
+async function categoryDelegations(dacId: string, category: number) {
+  const res = await shared.dacproposals_contract.catdelegsTable({
+    scope: dacId,
+    limit: 1000,
+  });
+  return res.rows.filter((d) => d.category == category);
+}
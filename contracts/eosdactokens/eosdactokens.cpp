@@ -1,6 +1,8 @@
 #include "eosdactokens.hpp"
 
 #include <algorithm>
+#include <map>
+#include <set>
 
 namespace eosdac {
     eosdactokens::eosdactokens(name s, name code, datastream<const char *> ds) : contract(s, code, ds) {}
@@ -97,40 +99,134 @@ namespace eosdac {
     }
 
     void eosdactokens::transfer(name from, name to, asset quantity, string memo) {
-        check(from != to, "ERR::TRANSFER_TO_SELF::cannot transfer to self");
+        const auto token = load_token_context(quantity.symbol.code());
+
+        move_balance(from, to, quantity, memo, token);
+
+        // Send to notify of balance change
+        vector<account_balance_delta> account_weights;
+        account_weights.push_back(account_balance_delta{from, quantity * -1});
+        account_weights.push_back(account_balance_delta{to, quantity});
+
+        send_balance_notification(account_weights, token.dac);
+    }
+
+    void eosdactokens::transfers(vector<transfer_item> items) {
+        check(!items.empty(), "ERR::TRANSFERS_EMPTY::No transfers supplied");
+
+        auto tokens         = std::map<symbol_code, token_context>{};
+        auto balance_deltas = std::map<symbol_code, std::map<name, int64_t>>{};
+        for (const auto &item : items) {
+            const auto sym   = item.quantity.symbol.code();
+            auto       token = tokens.find(sym);
+            if (token == tokens.end()) {
+                token = tokens.emplace(sym, load_token_context(sym)).first;
+            }
+
+            move_balance(item.from, item.to, item.quantity, item.memo, token->second);
+
+            auto &deltas = balance_deltas[sym];
+            deltas[item.from] -= item.quantity.amount;
+            deltas[item.to] += item.quantity.amount;
+        }
+
+        // One balance notification per token for the whole batch, with the net change of every account
+        for (const auto &[sym, deltas] : balance_deltas) {
+            const auto &token           = tokens.at(sym);
+            auto        account_weights = vector<account_balance_delta>{};
+            for (const auto &[account, amount] : deltas) {
+                if (amount != 0) {
+                    account_weights.push_back(account_balance_delta{account, asset{amount, token.stats.supply.symbol}});
+                }
+            }
+            if (!account_weights.empty()) {
+                send_balance_notification(account_weights, token.dac);
+            }
+        }
+    }
+
+    void eosdactokens::transfermany(name from, vector<pair<name, asset>> transfers, string memo) {
         require_auth(from);
-        check(is_account(to), "ERR::TRANSFER_NONEXISTING_DESTN::to account does not exist");
+        check(!transfers.empty(), "ERR::TRANSFERS_EMPTY::No transfers supplied");
+        check(memo.size() <= 256, "ERR::TRANSFER_MEMO_TOO_LONG::memo has more than 256 bytes");
 
-        check_transfer_allowed(to);
+        const auto  token = load_token_context(transfers.front().second.symbol.code());
+        const auto &st    = token.stats;
+
+        // Validate every leg and sum the credits per recipient so each balance row is touched once
+        auto total   = asset{0, st.supply.symbol};
+        auto credits = std::map<name, int64_t>{};
+        for (const auto &[to, quantity] : transfers) {
+            check(from != to, "ERR::TRANSFER_TO_SELF::cannot transfer to self");
+            check(quantity.is_valid(), "ERR::TRANSFER_INVALID_QTY::invalid quantity");
+            check(quantity.amount > 0, "ERR::TRANSFER_NON_POSITIVE_QTY::must transfer positive quantity");
+            check(quantity.symbol == st.supply.symbol, "ERR::TRANSFER_SYMBOL_MISMATCH::symbol precision mismatch");
+            if (to != st.issuer && st.transfer_locked) {
+                check(has_auth(st.issuer), "Transfer is locked, need issuer permission");
+            }
 
-        auto        sym = quantity.symbol.code();
+            total += quantity;
+            credits[to] += quantity.amount;
+        }
+
+        // Check transfer doesnt exceed stake
+        if (token.stakeconfig.enabled && eosdac::has_stake_state(from, get_self(), token.dac)) {
+            asset liquid = eosdac::get_liquid(from, get_self(), token.dac);
+
+            check(total <= liquid,
+                "ERR::BALANCE_STAKED::Attempting to transfer %s but liquid balance is only %s, unstake first", total,
+                liquid);
+        }
+
+        require_recipient(from);
+        sub_balance(from, total);
+
+        vector<account_balance_delta> account_weights;
+        account_weights.push_back(account_balance_delta{from, total * -1});
+        for (const auto &[to, amount] : credits) {
+            check(is_account(to), "ERR::TRANSFER_NONEXISTING_DESTN::to account does not exist");
+            check_transfer_allowed(to);
+            require_recipient(to);
+
+            const auto quantity = asset{amount, st.supply.symbol};
+            add_balance(to, quantity, has_auth(to) ? to : from);
+            account_weights.push_back(account_balance_delta{to, quantity});
+        }
+
+        send_balance_notification(account_weights, token.dac);
+    }
+
+    eosdactokens::token_context eosdactokens::load_token_context(const symbol_code &sym) {
         stats       statstable(_self, sym.raw());
         const auto &st = statstable.get(sym.raw(), fmt("eosdactokens::transfer Symbol %s not found", sym));
 
+        dacdir::dac dac = dacdir::dac_for_symbol(extended_symbol{st.supply.symbol, get_self()});
+        return token_context{st, dac, stake_config::get_current_configs(get_self(), dac.dac_id)};
+    }
+
+    void eosdactokens::move_balance(
+        name from, name to, const asset &quantity, const string &memo, const token_context &token) {
+        check(from != to, "ERR::TRANSFER_TO_SELF::cannot transfer to self");
+        require_auth(from);
+        check(is_account(to), "ERR::TRANSFER_NONEXISTING_DESTN::to account does not exist");
+
+        check_transfer_allowed(to);
+
+        const auto &st = token.stats;
         if (to != st.issuer && st.transfer_locked) {
             check(has_auth(st.issuer), "Transfer is locked, need issuer permission");
         }
 
         require_recipient(from, to);
 
-        dacdir::dac dac = dacdir::dac_for_symbol(extended_symbol{quantity.symbol, get_self()});
-
-        // Send to notify of balance change
-        vector<account_balance_delta> account_weights;
-        account_weights.push_back(account_balance_delta{from, quantity * -1});
-        account_weights.push_back(account_balance_delta{to, quantity});
-
-        send_balance_notification(account_weights, dac);
-
         check(quantity.is_valid(), "ERR::TRANSFER_INVALID_QTY::invalid quantity");
         check(quantity.amount > 0, "ERR::TRANSFER_NON_POSITIVE_QTY::must transfer positive quantity");
         check(quantity.symbol == st.supply.symbol, "ERR::TRANSFER_SYMBOL_MISMATCH::symbol precision mismatch");
         check(memo.size() <= 256, "ERR::TRANSFER_MEMO_TOO_LONG::memo has more than 256 bytes");
 
         // Check transfer doesnt exceed stake
-        stake_config stakeconfig = stake_config::get_current_configs(get_self(), dac.dac_id);
-        if (stakeconfig.enabled) {
-            asset liquid = eosdac::get_liquid(from, get_self(), quantity.symbol);
+        if (token.stakeconfig.enabled && eosdac::has_stake_state(from, get_self(), token.dac)) {
+            asset liquid = eosdac::get_liquid(from, get_self(), token.dac);
 
             check(quantity <= liquid,
                 "ERR::BALANCE_STAKED::Attempting to transfer %s but liquid balance is only %s, unstake first", quantity,
@@ -146,7 +242,7 @@ namespace eosdac {
     void eosdactokens::claimunstkes(const name account, const symbol token_symbol) {
         require_auth(account);
 
-        // get_liquid has the side effect of erasing any unstakes that have expired
+        // get_liquid has the side effect of erasing unstakes that have expired, UNSTAKE_COLLECT_BATCH rows at a time
         eosdac::get_liquid(account, get_self(), token_symbol);
     }
 
@@ -214,6 +310,8 @@ namespace eosdac {
             termsinfo.hash    = hash;
             termsinfo.version = next_version;
         });
+
+        terms_version_container(get_self(), dac_id.value).set(terms_version{next_version}, auth_account);
     }
 
     void eosdactokens::memberreg(name sender, string agreedterms, name dac_id) {
@@ -250,7 +348,7 @@ namespace eosdac {
         candidates_table candidatesTable = candidates_table(custodian_account, dac_id.value);
         auto             candidateidx    = candidatesTable.find(sender.value);
         if (candidateidx != candidatesTable.end()) {
-            print("checking for sender account");
+            LOG_DEBUG("checking for sender account");
 
             check(candidateidx->is_active != 1,
                 "ERR::MEMBERUNREG_ACTIVE_CANDIDATE::An active candidate must resign their nomination as candidate before being able to unregister from the members.");
@@ -289,7 +387,7 @@ namespace eosdac {
 
             asset liquid = eosdac::get_liquid(from, get_self(), quantity.symbol);
 
-            print("Liquid balance ", liquid, "\n");
+            LOG_DEBUG("Liquid balance ", liquid, "\n");
 
             check(liquid >= quantity, "ERR::STAKE_MORE_LIQUID::Attempting to stake more than your liquid balance");
 
@@ -309,112 +407,180 @@ namespace eosdac {
         stake_config config = stake_config::get_current_configs(get_self(), dac.dac_id);
         check(config.enabled, "ERR::STAKING_NOT_ENABLED::Staking is not enabled for this token");
 
-        check(quantity.is_valid(), "ERR::STAKE_INVALID_QTY::Invalid quantity supplied");
-        check(quantity.amount > 0, "ERR::STAKE_NON_POSITIVE_QTY::Stake amount must be greater than 0");
-
-        // The following will also delete any previously configure staketimes. Otherwise users could get locked into 6 month staking instead of only 2 days.
-        auto liquid = eosdac::get_liquid(account, get_self(), quantity.symbol);
-
-        check(liquid >= quantity, "ERR::STAKE_MORE_LIQUID::Attempting to stake %s but your liquid balance is only %s",
-            quantity, liquid);
-
-        add_stake(account, quantity, dac.dac_id, account);
-
-        // notify of stake delta
-        send_stake_notification(account, quantity, dac);
+        auto stake_deltas = vector<account_stake_delta>{};
+        apply_stake_ops(account, {{"stake"_n, quantity, 0}}, dac, config, stake_deltas);
+        send_stake_notification(stake_deltas, dac);
     }
 
     void eosdactokens::unstake(name account, asset quantity) {
         require_auth(account);
 
-        dacdir::dac    dac = dacdir::dac_for_symbol(extended_symbol{quantity.symbol, get_self()});
-        stakes_table   stakes(get_self(), dac.dac_id.value);
-        unstakes_table unstakes(get_self(), dac.dac_id.value);
-        stake_config   config = stake_config::get_current_configs(get_self(), dac.dac_id);
-
+        dacdir::dac  dac    = dacdir::dac_for_symbol(extended_symbol{quantity.symbol, get_self()});
+        stake_config config = stake_config::get_current_configs(get_self(), dac.dac_id);
         check(config.enabled, "ERR::STAKING_NOT_ENABLED::Staking is not enabled for this token");
-        check(quantity.is_valid(), "ERR::STAKE_INVALID_QTY::Invalid quantity supplied");
-        check(quantity.amount > 0, "ERR::UNSTAKE_NON_POSITIVE_QTY::Unstake amount must be greater than 0");
 
-        auto existing_stake = stakes.find(account.value);
-        check(existing_stake != stakes.end(), "ERR:NO_STAKE_FOUND::No stake found");
-        check(existing_stake->stake >= quantity,
-            "ERR::UNSTAKE_OVER::Quantity to unstake %s is more than staked amount %s", quantity, existing_stake->stake);
+        auto stake_deltas = vector<account_stake_delta>{};
+        apply_stake_ops(account, {{"unstake"_n, quantity, 0}}, dac, config, stake_deltas);
+        send_stake_notification(stake_deltas, dac);
+    }
 
-        uint32_t         unstake_delay = config.min_stake_time;
-        staketimes_table staketimes(get_self(), dac.dac_id.value);
-        auto             existing_staketime = staketimes.find(account.value);
-        if (existing_staketime != staketimes.end()) {
-            unstake_delay = existing_staketime->delay;
-        }
-        uint32_t release_time = current_time_point().sec_since_epoch() + unstake_delay;
-
-        uint64_t next_id = unstakes.available_primary_key();
-        unstakes.emplace(account, [&](unstake_info &u) {
-            u.key          = next_id;
-            u.account      = account;
-            u.stake        = quantity;
-            u.release_time = time_point_sec(release_time);
-        });
+    void eosdactokens::staketime(name account, uint32_t unstake_time, symbol token_symbol) {
+        require_auth(account);
 
-        // notify of stake delta
-        send_stake_notification(account, -quantity, dac);
+        dacdir::dac  dac    = dacdir::dac_for_symbol(extended_symbol{token_symbol, get_self()});
+        stake_config config = stake_config::get_current_configs(get_self(), dac.dac_id);
+        check(config.enabled, "ERR::STAKING_NOT_ENABLED::Staking is not enabled for this token");
 
-        // Remove from stake
-        sub_stake(account, quantity, dac.dac_id);
+        auto stake_deltas = vector<account_stake_delta>{};
+        apply_stake_ops(account, {{"staketime"_n, asset{0, token_symbol}, unstake_time}}, dac, config, stake_deltas);
+        send_stake_notification(stake_deltas, dac);
     }
 
-    void eosdactokens::staketime(name account, uint32_t unstake_time, symbol token_symbol) {
+    void eosdactokens::stakebatch(name account, vector<stake_op> ops, symbol token_symbol) {
         require_auth(account);
 
         dacdir::dac  dac    = dacdir::dac_for_symbol(extended_symbol{token_symbol, get_self()});
         stake_config config = stake_config::get_current_configs(get_self(), dac.dac_id);
         check(config.enabled, "ERR::STAKING_NOT_ENABLED::Staking is not enabled for this token");
-        staketimes_table staketimes(get_self(), dac.dac_id.value);
+        check(!ops.empty(), "ERR::STAKEBATCH_EMPTY::No stake operations supplied");
+
+        auto stake_deltas = vector<account_stake_delta>{};
+        apply_stake_ops(account, ops, dac, config, stake_deltas);
+        send_stake_notification(stake_deltas, dac);
+    }
+
+    void eosdactokens::stakemulti(vector<account_stake_ops> batches, symbol token_symbol) {
+        dacdir::dac  dac    = dacdir::dac_for_symbol(extended_symbol{token_symbol, get_self()});
+        stake_config config = stake_config::get_current_configs(get_self(), dac.dac_id);
+        check(config.enabled, "ERR::STAKING_NOT_ENABLED::Staking is not enabled for this token");
+        check(!batches.empty(), "ERR::STAKEBATCH_EMPTY::No stake operations supplied");
+
+        auto seen         = std::set<name>{};
+        auto stake_deltas = vector<account_stake_delta>{};
+        for (const auto &batch : batches) {
+            require_auth(batch.account);
+            check(seen.insert(batch.account).second,
+                "ERR::STAKEMULTI_DUPLICATE_ACCOUNT::%s appears more than once, combine its operations into one batch",
+                batch.account);
+            check(!batch.ops.empty(), "ERR::STAKEBATCH_EMPTY::No stake operations supplied for %s", batch.account);
+
+            apply_stake_ops(batch.account, batch.ops, dac, config, stake_deltas);
+        }
+        send_stake_notification(stake_deltas, dac);
+    }
+
+    /**
+     * Applies a sequence of stake, unstake and staketime operations for one account and appends the resulting stake
+     * deltas to stake_deltas. The liquid balance is computed (and released unstakes collected) at most once, and the
+     * deltas are aggregated: a single net delta, or when the unstake delay changed the whole previous stake removed at
+     * the old delay and the new stake added at the new one.
+     */
+    void eosdactokens::apply_stake_ops(const name account, const vector<stake_op> &ops, const dacdir::dac &dac,
+        const stake_config &config, vector<account_stake_delta> &stake_deltas) {
+        const auto       token_symbol = dac.symbol.get_symbol();
         stakes_table     stakes(get_self(), dac.dac_id.value);
         unstakes_table   unstakes(get_self(), dac.dac_id.value);
+        staketimes_table staketimes(get_self(), dac.dac_id.value);
         auto             unstakes_idx = unstakes.get_index<"byaccount"_n>();
 
-        check(unstake_time <= config.max_stake_time,
-            "ERR::TIME_GREATER_MAX::Unstake time %s is greater than the maximum %s", unstake_time,
-            config.max_stake_time);
-        check(unstake_time >= config.min_stake_time, "ERR::TIME_LESS_MIN::Unstake time %s is less than the minimum %s",
-            unstake_time, config.min_stake_time);
-
-        auto existing_stake   = stakes.find(account.value);
-        auto existing_unstake = unstakes_idx.find(account.value);
-        auto existing_time    = staketimes.find(account.value);
-        if ((existing_stake != stakes.end() || existing_unstake != unstakes_idx.end()) &&
-            existing_time != staketimes.end()) {
-            check(existing_time->delay <= unstake_time,
-                "ERR::CANNOT_REDUCE_STAKE_TIME::You cannot reduce the stake time (from %s to %s) if you have tokens staked or in the process of unstaking",
-                existing_time->delay, unstake_time);
+        // Validate the parameters of every operation before touching any table
+        auto stakes_in_batch = false;
+        for (const auto &op : ops) {
+            if (op.type == "stake"_n || op.type == "unstake"_n) {
+                check(op.quantity.is_valid(), "ERR::STAKE_INVALID_QTY::Invalid quantity supplied");
+                check(op.quantity.symbol == token_symbol, "ERR::STAKE_WRONG_SYMBOL::Expected %s but got %s",
+                    token_symbol, op.quantity.symbol);
+                if (op.type == "stake"_n) {
+                    check(op.quantity.amount > 0, "ERR::STAKE_NON_POSITIVE_QTY::Stake amount must be greater than 0");
+                    stakes_in_batch = true;
+                } else {
+                    check(op.quantity.amount > 0,
+                        "ERR::UNSTAKE_NON_POSITIVE_QTY::Unstake amount must be greater than 0");
+                }
+            } else if (op.type == "staketime"_n) {
+                check(op.unstake_time <= config.max_stake_time,
+                    "ERR::TIME_GREATER_MAX::Unstake time %s is greater than the maximum %s", op.unstake_time,
+                    config.max_stake_time);
+                check(op.unstake_time >= config.min_stake_time,
+                    "ERR::TIME_LESS_MIN::Unstake time %s is less than the minimum %s", op.unstake_time,
+                    config.min_stake_time);
+            } else {
+                check(false, "ERR::STAKE_OP_UNKNOWN::Unknown stake operation %s", op.type);
+            }
         }
 
-        const auto unstake_time_before = staketime_info::get_delay(get_self(), dac.dac_id, account);
+        // The following will also delete any previously configure staketimes. Otherwise users could get locked into 6
+        // month staking instead of only 2 days.
+        auto liquid = stakes_in_batch ? eosdac::get_liquid(account, get_self(), dac) : asset{0, token_symbol};
+
+        const auto existing_stake = stakes.find(account.value);
+        const auto stake_before   = existing_stake != stakes.end() ? existing_stake->stake : asset{0, token_symbol};
+        const auto delay_before   = staketime_info::get_delay(get_self(), dac.dac_id, account);
+
+        auto stake = stake_before;
+        auto delay = delay_before;
+        for (const auto &op : ops) {
+            if (op.type == "stake"_n) {
+                check(liquid >= op.quantity,
+                    "ERR::STAKE_MORE_LIQUID::Attempting to stake %s but your liquid balance is only %s", op.quantity,
+                    liquid);
+
+                add_stake(account, op.quantity, dac.dac_id, account);
+                liquid -= op.quantity;
+                stake += op.quantity;
+            } else if (op.type == "unstake"_n) {
+                check(stake.amount > 0, "ERR:NO_STAKE_FOUND::No stake found");
+                check(stake >= op.quantity, "ERR::UNSTAKE_OVER::Quantity to unstake %s is more than staked amount %s",
+                    op.quantity, stake);
+
+                uint32_t release_time = current_time_point().sec_since_epoch() + delay;
+                add_unstake_total(account, get_self(), dac, op.quantity, time_point_sec(release_time));
+
+                uint64_t next_id = unstakes.available_primary_key();
+                unstakes.emplace(account, [&](unstake_info &u) {
+                    u.key          = next_id;
+                    u.account      = account;
+                    u.stake        = op.quantity;
+                    u.release_time = time_point_sec(release_time);
+                });
 
-        if (existing_time == staketimes.end()) {
-            staketimes.emplace(account, [&](staketime_info &s) {
-                s.account = account;
-                s.delay   = unstake_time;
-            });
-        } else {
-            staketimes.modify(*existing_time, account, [&](staketime_info &s) {
-                s.delay = unstake_time;
-            });
+                // Remove from stake
+                sub_stake(account, op.quantity, dac.dac_id);
+                stake -= op.quantity;
+            } else {
+                auto existing_time = staketimes.find(account.value);
+                if ((stake.amount > 0 || unstakes_idx.find(account.value) != unstakes_idx.end()) &&
+                    existing_time != staketimes.end()) {
+                    check(existing_time->delay <= op.unstake_time,
+                        "ERR::CANNOT_REDUCE_STAKE_TIME::You cannot reduce the stake time (from %s to %s) if you have tokens staked or in the process of unstaking",
+                        existing_time->delay, op.unstake_time);
+                }
+
+                if (existing_time == staketimes.end()) {
+                    staketimes.emplace(account, [&](staketime_info &s) {
+                        s.account = account;
+                        s.delay   = op.unstake_time;
+                    });
+                } else {
+                    staketimes.modify(*existing_time, account, [&](staketime_info &s) {
+                        s.delay = op.unstake_time;
+                    });
+                }
+                delay = op.unstake_time;
+            }
         }
 
-        // send notification for unstake at current delay and then stake with new delay
-        const auto custodian_contract = dac.account_for_type_maybe(dacdir::CUSTODIAN);
-        const auto vote_contract      = dac.account_for_type_maybe(dacdir::VOTE_WEIGHT);
-        const auto notify_contract    = (vote_contract) ? *vote_contract : *custodian_contract;
-        asset      current_stake      = eosdac::get_staked(account, get_self(), token_symbol);
-
-        account_stake_delta         stake_deltas_sub = {account, -current_stake, unstake_time_before};
-        account_stake_delta         stake_deltas_add = {account, current_stake, unstake_time};
-        vector<account_stake_delta> deltas           = {stake_deltas_sub, stake_deltas_add};
-        action(permission_level{get_self(), "notify"_n}, notify_contract, "stakeobsv"_n, make_tuple(deltas, dac.dac_id))
-            .send();
+        if (delay != delay_before) {
+            // unstake at the previous delay and then stake with the new delay
+            if (stake_before.amount != 0) {
+                stake_deltas.push_back({account, -stake_before, delay_before});
+            }
+            if (stake.amount != 0) {
+                stake_deltas.push_back({account, stake, delay});
+            }
+        } else if (stake != stake_before) {
+            stake_deltas.push_back({account, stake - stake_before, delay});
+        }
     }
 
     void eosdactokens::stakeconfig(stake_config config, symbol token_symbol) {
@@ -453,11 +619,36 @@ namespace eosdac {
         // Add stake back and delete the unstake so the liquid balance is correct
         add_stake(us->account, us->stake, dac.dac_id, us->account);
 
-        send_stake_notification(us->account, us->stake, dac);
+        const auto unstake_delay = staketime_info::get_delay(get_self(), dac.dac_id, us->account);
+        send_stake_notification({{us->account, us->stake, unstake_delay}}, dac);
 
+        sub_unstake_total(us->account, get_self(), dac, us->stake);
         unstakes.erase(us);
     }
 
+#ifdef IS_DEV
+    void eosdactokens::tstaddunstk(name account, asset quantity, uint32_t delay, uint16_t count) {
+        require_auth(get_self());
+        dacdir::dac    dac = dacdir::dac_for_symbol(extended_symbol{quantity.symbol, get_self()});
+        unstakes_table unstakes(get_self(), dac.dac_id.value);
+
+        const auto release_time = time_point_sec(current_time_point().sec_since_epoch() + delay);
+        for (auto i = uint16_t{0}; i < count; i++) {
+            unstakes.emplace(get_self(), [&](unstake_info &u) {
+                u.key          = unstakes.available_primary_key();
+                u.account      = account;
+                u.stake        = quantity;
+                u.release_time = release_time;
+            });
+        }
+    }
+
+    void eosdactokens::tstrmtermsv(name dac_id) {
+        require_auth(get_self());
+        terms_version_container(get_self(), dac_id.value).remove();
+    }
+#endif
+
     void eosdactokens::sub_stake(name account, asset value, name dac_id) {
         stakes_table stakes(get_self(), dac_id.value);
         auto         existing_stake = stakes.find(account.value);
@@ -488,22 +679,36 @@ namespace eosdac {
         }
     }
 
-    void eosdactokens::send_stake_notification(name account, asset stake, dacdir::dac dac_inst) {
+    void eosdactokens::send_stake_notification(
+        const vector<account_stake_delta> &stake_deltas, const dacdir::dac &dac_inst) {
+        if (stake_deltas.empty()) {
+            return;
+        }
+
         const auto custodian_contract  = dac_inst.account_for_type_maybe(dacdir::CUSTODIAN);
         const auto vote_contract       = dac_inst.account_for_type_maybe(dacdir::VOTE_WEIGHT);
         const auto referendum_contract = dac_inst.account_for_type_maybe(dacdir::REFERENDUM);
         const auto notify_contract     = (vote_contract) ? *vote_contract : *custodian_contract;
 
-        const auto unstake_delay = staketime_info::get_delay(get_self(), dac_inst.dac_id, account);
-
-        vector<account_stake_delta> stake_deltas = {{account, stake, unstake_delay}};
         action(permission_level{get_self(), "notify"_n}, notify_contract, "stakeobsv"_n,
             make_tuple(stake_deltas, dac_inst.dac_id))
             .send();
 
-        if (referendum_contract && is_account(*referendum_contract)) {
+        // Referendum votes only follow the staked amount, so leave out accounts whose stake only moved to a new delay
+        // (a pure staketime change). The net is taken per account as stakemulti can carry several accounts.
+        auto net_stake = std::map<name, int64_t>{};
+        for (const auto &asd : stake_deltas) {
+            net_stake[asd.account] += asd.stake_delta.amount;
+        }
+        auto referendum_deltas = vector<account_stake_delta>{};
+        for (const auto &asd : stake_deltas) {
+            if (net_stake[asd.account] != 0) {
+                referendum_deltas.push_back(asd);
+            }
+        }
+        if (!referendum_deltas.empty() && referendum_contract && is_account(*referendum_contract)) {
             action(permission_level{get_self(), "notify"_n}, *referendum_contract, "stakeobsv"_n,
-                make_tuple(stake_deltas, dac_inst.dac_id))
+                make_tuple(referendum_deltas, dac_inst.dac_id))
                 .send();
         }
     }
@@ -525,7 +730,7 @@ namespace eosdac {
             make_tuple(account_weights, dac_inst.dac_id))
             .send();
 
-        print("notifying balance change to ", balance_obsv_contract, "::balanceobsv");
+        LOG_DEBUG("notifying balance change to ", balance_obsv_contract, "::balanceobsv");
     }
 
     void eosdactokens::chngissuer() {
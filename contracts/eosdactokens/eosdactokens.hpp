@@ -24,11 +24,33 @@ namespace eosdac {
         using contract::contract;
         eosdactokens(name s, name code, datastream<const char *> ds);
 
+        // One step of stakebatch / stakemulti. type is stake, unstake or staketime; quantity is used by stake and
+        // unstake, unstake_time by staketime.
+        struct stake_op {
+            name     type;
+            asset    quantity;
+            uint32_t unstake_time;
+        };
+
+        struct account_stake_ops {
+            name             account;
+            vector<stake_op> ops;
+        };
+
+        struct transfer_item {
+            name   from;
+            name   to;
+            asset  quantity;
+            string memo;
+        };
+
         ACTION create(name issuer, asset maximum_supply, bool transfer_locked);
         ACTION issue(name to, asset quantity, string memo);
         ACTION unlock(asset unlock);
         ACTION burn(name from, asset quantity);
         ACTION transfer(name from, name to, asset quantity, string memo);
+        ACTION transfers(vector<transfer_item> items);
+        ACTION transfermany(name from, vector<pair<name, asset>> transfers, string memo);
         ACTION newmemterms(string terms, string hash, name dac_id);
         ACTION memberreg(name sender, string agreedterms, name dac_id);
         ACTION memberunreg(name sender, name dac_id);
@@ -43,7 +65,16 @@ namespace eosdac {
         ACTION stakeconfig(stake_config config, symbol token_symbol);
         ACTION cancel(uint64_t unstake_id, symbol token_symbol);
         ACTION claimunstkes(const name account, const symbol token_symbol);
+        ACTION stakebatch(name account, vector<stake_op> ops, symbol token_symbol);
+        ACTION stakemulti(vector<account_stake_ops> batches, symbol token_symbol);
         ACTION chngissuer();
+#ifdef IS_DEV
+        // Adds count unstakes of quantity, released after delay seconds, without their unstake total, as they were
+        // written before the totals were tracked
+        ACTION tstaddunstk(name account, asset quantity, uint32_t delay, uint16_t count);
+        // Removes the termsver singleton, as for terms published before the version was tracked
+        ACTION tstrmtermsv(name dac_id);
+#endif
 
         TABLE stake_info {
             name  account;
@@ -177,12 +208,24 @@ namespace eosdac {
                 "Planetary tokens are being transitioned to have a staking/voting mechanism only. Convert these to TLM for use cases beyond voting and staking.");
         }
 
+        // Everything a transfer needs that only depends on the token
+        struct token_context {
+            currency_stats stats;
+            dacdir::dac    dac;
+            stake_config   stakeconfig;
+        };
+
+        token_context load_token_context(const symbol_code &sym);
+        void move_balance(name from, name to, const asset &quantity, const string &memo, const token_context &token);
+
         void sub_balance(name owner, asset value);
         void add_balance(name owner, asset value, name payer);
         void sub_stake(name owner, asset value, name dac_id);
         void add_stake(name owner, asset value, name dac_id, name ram_payer);
 
-        void send_stake_notification(name account, asset stake, dacdir::dac dac_inst);
+        void apply_stake_ops(const name account, const vector<stake_op> &ops, const dacdir::dac &dac,
+            const stake_config &config, vector<account_stake_delta> &stake_deltas);
+        void send_stake_notification(const vector<account_stake_delta> &stake_deltas, const dacdir::dac &dac_inst);
         void send_balance_notification(vector<account_balance_delta> account_weights, dacdir::dac dac_inst);
     };
 
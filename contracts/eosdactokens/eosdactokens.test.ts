@@ -733,6 +733,141 @@ describe('EOSDacTokens', () => {
           ]
         );
       });
+      it('stakebatch should reject an unknown operation', async () => {
+        await l.assertEOSErrorIncludesMessage(
+          shared.dac_token_contract.stakebatch(
+            user2.name,
+            [{ type: 'transfer', quantity: '1.0000 ABC', unstake_time: 0 }],
+            '4,ABC',
+            { from: user2 }
+          ),
+          'ERR::STAKE_OP_UNKNOWN'
+        );
+      });
+      it('stakebatch should apply all operations in one action', async () => {
+        await shared.dac_token_contract.stakebatch(
+          user2.name,
+          [
+            { type: 'staketime', quantity: '0.0000 ABC', unstake_time: 15 },
+            { type: 'stake', quantity: '30.0000 ABC', unstake_time: 0 },
+            { type: 'unstake', quantity: '10.0000 ABC', unstake_time: 0 },
+          ],
+          '4,ABC',
+          { from: user2 }
+        );
+        await l.assertRowsEqual(
+          shared.dac_token_contract.stakesTable({
+            scope: 'abcdac',
+            lowerBound: user2.name,
+            upperBound: user2.name,
+          }),
+          [{ account: user2.name, stake: '20.0000 ABC' }]
+        );
+        await l.assertRowsEqual(
+          shared.dac_token_contract.staketimeTable({
+            scope: 'abcdac',
+            lowerBound: user2.name,
+            upperBound: user2.name,
+          }),
+          [{ account: user2.name, delay: 15 }]
+        );
+      });
+      it('stakemulti should require the auth of every account', async () => {
+        await l.assertMissingAuthority(
+          shared.dac_token_contract.stakemulti(
+            [
+              {
+                account: user1.name,
+                ops: [
+                  { type: 'stake', quantity: '5.0000 ABC', unstake_time: 0 },
+                ],
+              },
+              {
+                account: user2.name,
+                ops: [
+                  { type: 'unstake', quantity: '5.0000 ABC', unstake_time: 0 },
+                ],
+              },
+            ],
+            '4,ABC',
+            { from: user1 }
+          )
+        );
+      });
+      it('stakemulti should reject an account listed twice', async () => {
+        await l.assertEOSErrorIncludesMessage(
+          shared.dac_token_contract.stakemulti(
+            [
+              {
+                account: user1.name,
+                ops: [
+                  { type: 'stake', quantity: '5.0000 ABC', unstake_time: 0 },
+                ],
+              },
+              {
+                account: user1.name,
+                ops: [
+                  { type: 'stake', quantity: '5.0000 ABC', unstake_time: 0 },
+                ],
+              },
+            ],
+            '4,ABC',
+            { from: user1 }
+          ),
+          'ERR::STAKEMULTI_DUPLICATE_ACCOUNT'
+        );
+      });
+      it('stakemulti should send one net delta per account', async () => {
+        const res: any = await shared.dac_token_contract.stakemulti(
+          [
+            {
+              account: user1.name,
+              ops: [
+                { type: 'stake', quantity: '4.0000 ABC', unstake_time: 0 },
+                { type: 'stake', quantity: '6.0000 ABC', unstake_time: 0 },
+              ],
+            },
+            {
+              account: user2.name,
+              ops: [
+                { type: 'unstake', quantity: '10.0000 ABC', unstake_time: 0 },
+              ],
+            },
+          ],
+          '4,ABC',
+          {
+            auths: [
+              { actor: user1.name, permission: 'active' },
+              { actor: user2.name, permission: 'active' },
+            ],
+          }
+        );
+        await l.assertRowsEqual(
+          shared.dac_token_contract.stakesTable({
+            scope: 'abcdac',
+            lowerBound: user1.name,
+            upperBound: user2.name,
+          }),
+          [
+            { account: user1.name, stake: '10.0000 ABC' },
+            { account: user2.name, stake: '10.0000 ABC' },
+          ]
+        );
+        const observed = res.processed.action_traces[0].inline_traces.find(
+          (trace: any) => trace.act.name == 'stakeobsv'
+        );
+        chai
+          .expect(
+            observed.act.data.stake_deltas.map((d: any) => ({
+              account: d.account,
+              stake_delta: d.stake_delta,
+            }))
+          )
+          .to.deep.equal([
+            { account: user1.name, stake_delta: '10.0000 ABC' },
+            { account: user2.name, stake_delta: '-10.0000 ABC' },
+          ]);
+      });
     });
   });
 
@@ -768,6 +903,94 @@ describe('EOSDacTokens', () => {
           );
         });
       });
+      context('from an account that never staked', async () => {
+        let fresh: l.Account;
+        before(async () => {
+          fresh = await l.AccountManager.createAccount();
+          await shared.dac_token_contract.issue(
+            issuer.name,
+            '20.0000 ABC',
+            'initial issued tokens',
+            { from: issuer }
+          );
+          await shared.dac_token_contract.transfer(
+            issuer.name,
+            fresh.name,
+            '20.0000 ABC',
+            'memo',
+            { from: issuer }
+          );
+        });
+        it('should move the whole balance', async () => {
+          await shared.dac_token_contract.transfer(
+            fresh.name,
+            receiver.name,
+            '20.0000 ABC',
+            'memo',
+            { from: fresh }
+          );
+          await l.assertRowsEqual(
+            shared.dac_token_contract.accountsTable({ scope: fresh.name }),
+            [{ balance: '0.0000 ABC' }]
+          );
+        });
+      });
+      context('from an account with only a pending unstake', async () => {
+        let unstaker: l.Account;
+        before(async () => {
+          unstaker = await l.AccountManager.createAccount();
+          await shared.dac_token_contract.issue(
+            issuer.name,
+            '50.0000 ABC',
+            'initial issued tokens',
+            { from: issuer }
+          );
+          await shared.dac_token_contract.transfer(
+            issuer.name,
+            unstaker.name,
+            '50.0000 ABC',
+            'memo',
+            { from: issuer }
+          );
+          await shared.dac_token_contract.stake(unstaker.name, '20.0000 ABC', {
+            from: unstaker,
+          });
+          await shared.dac_token_contract.unstake(
+            unstaker.name,
+            '20.0000 ABC',
+            { from: unstaker }
+          );
+          await l.assertRowCount(
+            shared.dac_token_contract.stakesTable({
+              scope: 'abcdac',
+              lowerBound: unstaker.name,
+              upperBound: unstaker.name,
+            }),
+            0
+          );
+        });
+        it('should still not transfer the unstaking tokens', async () => {
+          await l.assertEOSErrorIncludesMessage(
+            shared.dac_token_contract.transfer(
+              unstaker.name,
+              receiver.name,
+              '40.0000 ABC',
+              'memo',
+              { from: unstaker }
+            ),
+            'ERR::BALANCE_STAKED'
+          );
+        });
+        it('should transfer the liquid part', async () => {
+          await shared.dac_token_contract.transfer(
+            unstaker.name,
+            receiver.name,
+            '30.0000 ABC',
+            'memo',
+            { from: unstaker }
+          );
+        });
+      });
       context(
         'with some staked but not enough liquid for transfer',
         async () => {
@@ -815,6 +1038,168 @@ describe('EOSDacTokens', () => {
           });
         }
       );
+      context('with a batch of transfers', async () => {
+        it('should apply every transfer in one action', async () => {
+          await shared.dac_token_contract.transfers(
+            [
+              {
+                from: receiver.name,
+                to: sender.name,
+                quantity: '4.0000 ABC',
+                memo: 'first',
+              },
+              {
+                from: receiver.name,
+                to: sender.name,
+                quantity: '6.0000 ABC',
+                memo: 'second',
+              },
+            ],
+            { from: receiver }
+          );
+          await l.assertRowsEqual(
+            shared.dac_token_contract.accountsTable({ scope: sender.name }),
+            [{ balance: '110.0000 ABC' }]
+          );
+        });
+      });
+      context('with transfermany', async () => {
+        it('should fail when the total exceeds the liquid balance', async () => {
+          await l.assertEOSErrorIncludesMessage(
+            shared.dac_token_contract.transfermany(
+              sender.name,
+              [
+                { first: receiver.name, second: '6.0000 ABC' },
+                { first: receiver.name, second: '5.0000 ABC' },
+              ],
+              'payroll',
+              { from: sender }
+            ),
+            'ERR::BALANCE_STAKED'
+          );
+        });
+        it('should debit the sender once for all recipients', async () => {
+          await shared.dac_token_contract.transfermany(
+            sender.name,
+            [
+              { first: receiver.name, second: '6.0000 ABC' },
+              { first: receiver.name, second: '4.0000 ABC' },
+            ],
+            'payroll',
+            { from: sender }
+          );
+          await l.assertRowsEqual(
+            shared.dac_token_contract.accountsTable({ scope: sender.name }),
+            [{ balance: '100.0000 ABC' }]
+          );
+        });
+      });
+    });
+  });
+  context('unstake totals', async () => {
+    let holder: l.Account;
+    let receiver: l.Account;
+    const unstakesOf = async (account: l.Account) => {
+      const res = await shared.dac_token_contract.unstakesTable({
+        scope: 'abcdac',
+        limit: 1000,
+      });
+      return res.rows.filter((row: any) => row.account == account.name);
+    };
+    const unstakeTotalOf = async (account: l.Account) => {
+      const res = await shared.dac_token_contract.unstaketotsTable({
+        scope: 'abcdac',
+        lowerBound: account.name,
+        upperBound: account.name,
+      });
+      return res.rows[0];
+    };
+    before(async () => {
+      holder = await l.AccountManager.createAccount();
+      receiver = await l.AccountManager.createAccount();
+      await shared.dac_token_contract.issue(
+        issuer.name,
+        '100.0000 ABC',
+        'initial issued tokens',
+        { from: issuer }
+      );
+      await shared.dac_token_contract.transfer(
+        issuer.name,
+        holder.name,
+        '100.0000 ABC',
+        'unstake totals',
+        { from: issuer }
+      );
+      // 60 unstakes written before the totals were tracked, released in 10s
+      await shared.dac_token_contract.tstaddunstk(
+        holder.name,
+        '1.0000 ABC',
+        10,
+        60
+      );
+    });
+    it('should start without an unstake total', async () => {
+      chai.expect(await unstakeTotalOf(holder)).to.equal(undefined);
+      chai.expect(await unstakesOf(holder)).to.have.lengthOf(60);
+    });
+    it('should build the total on first touch', async () => {
+      await shared.dac_token_contract.transfer(
+        holder.name,
+        receiver.name,
+        '30.0000 ABC',
+        'memo',
+        { from: holder }
+      );
+      chai
+        .expect((await unstakeTotalOf(holder)).pending)
+        .to.equal('60.0000 ABC');
+      await l.assertEOSErrorIncludesMessage(
+        shared.dac_token_contract.transfer(
+          holder.name,
+          receiver.name,
+          '20.0000 ABC',
+          'memo',
+          { from: holder }
+        ),
+        'ERR::BALANCE_STAKED'
+      );
+    });
+    it('cancel should reduce pending', async () => {
+      const [first] = await unstakesOf(holder);
+      await shared.dac_token_contract.cancel(first.key, '4,ABC', {
+        from: holder,
+      });
+      chai
+        .expect((await unstakeTotalOf(holder)).pending)
+        .to.equal('59.0000 ABC');
+      chai.expect(await unstakesOf(holder)).to.have.lengthOf(59);
+    });
+    it('claimunstkes should collect at most UNSTAKE_COLLECT_BATCH rows', async () => {
+      await l.sleep(11_000);
+      await shared.dac_token_contract.claimunstkes(holder.name, '4,ABC', {
+        from: holder,
+      });
+      const remaining = await unstakesOf(holder);
+      chai.expect(remaining).to.have.lengthOf(9);
+      // Released rows not collected yet still count as pending, so the liquid
+      // balance can only be too low, never too high.
+      chai
+        .expect((await unstakeTotalOf(holder)).pending)
+        .to.equal('9.0000 ABC');
+    });
+    it('claimunstkes should erase the total once everything is collected', async () => {
+      await shared.dac_token_contract.claimunstkes(holder.name, '4,ABC', {
+        from: holder,
+      });
+      chai.expect(await unstakesOf(holder)).to.have.lengthOf(0);
+      chai.expect(await unstakeTotalOf(holder)).to.equal(undefined);
+      await shared.dac_token_contract.transfer(
+        holder.name,
+        receiver.name,
+        '69.0000 ABC',
+        'memo',
+        { from: holder }
+      );
     });
   });
 });
@@ -268,7 +268,7 @@ void multisig::exec(name proposal_name, name executer, name dac_id) {
     }
 
     for (const auto &act : actions) {
-        print(act.account, act.name);
+        LOG_DEBUG(act.account, act.name);
         // auto toSend = action(permission_level{get_self(), "active"_n}, act.account, act.name, act.data);
         act.send();
     }
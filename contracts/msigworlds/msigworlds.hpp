@@ -263,8 +263,7 @@ class [[eosio::contract("msigworlds")]] multisig : public eosio::contract {
         const auto custodian_contract = dac.account_for_type_maybe(eosdac::dacdir::CUSTODIAN);
 
         if (custodian_contract) {
-            const auto custodians          = eosdac::custodians_table{*custodian_contract, dac_id.value};
-            const auto is_custodian        = custodians.find(proposer.value) != custodians.end();
+            const auto is_custodian        = eosdac::is_custodian(*custodian_contract, dac_id, proposer);
             const auto referendum_contract = dac.account_for_type_maybe(eosdac::dacdir::REFERENDUM);
 
             if (referendum_contract) {
@@ -58,7 +58,8 @@ void referendum::updateconfig(set_config_item new_config, name dac_id) {
 void referendum::propose(name proposer, name type_name, name voting_type_name, string title, string content,
     name dac_id, vector<action> acts) {
     require_auth(proposer);
-    assertValidMember(proposer, dac_id);
+    auto dac = dacdir::dac_for_id(dac_id);
+    assertValidMember(proposer, dac);
     auto ref_type    = referendum_type(type_name.value);
     auto voting_type = count_type(voting_type_name.value);
 
@@ -69,7 +70,6 @@ void referendum::propose(name proposer, name type_name, name voting_type_name, s
     switch (ref_type) {
     case referendum_type::TYPE_BINDING:
     case referendum_type::TYPE_SEMI_BINDING: {
-        auto dac          = dacdir::dac_for_id(dac_id);
         auto auth_account = dac.account_for_type(dacdir::account_type::MSIGOWNED);
 
         check(
@@ -122,7 +122,6 @@ void referendum::propose(name proposer, name type_name, name voting_type_name, s
         }
 
         // transfer fee to treasury account
-        const auto   dac              = dacdir::dac_for_id(dac_id);
         const auto   treasury_account = dac.account_for_type(dacdir::TREASURY);
         const string fee_memo         = fmt("Fee for referendum id %s", next_referendum_id);
         eosio::action(eosio::permission_level{get_self(), "active"_n}, fee_required.contract, "transfer"_n,
@@ -158,8 +157,8 @@ void referendum::propose(name proposer, name type_name, name voting_type_name, s
 
 void referendum::vote(name voter, uint64_t referendum_id, name vote, name dac_id) {
     require_auth(voter);
-    assertValidMember(voter, dac_id);
     auto dac = dacdir::dac_for_id(dac_id);
+    assertValidMember(voter, dac);
 
     referenda_table referenda(get_self(), dac_id.value);
     auto            ref = referenda.get(referendum_id, "ERR::REFERENDUM_NOT_FOUND::Referendum not found");
@@ -463,7 +462,7 @@ void referendum::proposeMsig(referendum_data ref, name dac_id) {
     while (count < num_reqs && cand_itr != cand_idx.end()) {
         name perm_name   = "active"_n;
         auto custom_perm = candperms.find(cand_itr->candidate_name.value);
-        if (custom_perm != candperms.end()) {
+        if (custom_perm != candperms.end() && custom_perm->permission_exists.value_or(true)) {
             perm_name = custom_perm->permission;
         }
         reqd_perms.push_back(permission_level{cand_itr->candidate_name, perm_name});
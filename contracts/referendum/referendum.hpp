@@ -44,8 +44,10 @@ CONTRACT referendum : public contract {
 
   public:
     struct [[eosio::table("candperms"), eosio::contract("daccustodian")]] candperm {
-        name cand;
-        name permission;
+        name                             cand;
+        name                             permission;
+        binary_extension<bool>           permission_exists;
+        binary_extension<time_point_sec> validated_at;
 
         uint64_t primary_key() const {
             return cand.value;
@@ -9,27 +9,49 @@ void stakevote::stakeobsv(const vector<account_stake_delta> &stake_deltas, const
 
     require_auth(token_contract);
 
-    const auto config         = config_item::get_current_configs(get_self(), dac_id);
-    const auto token_config   = stake_config::get_current_configs(token_contract, dac_id);
-    const auto max_stake_time = S{token_config.max_stake_time}.to<double>("stakeobsv max_stake_time");
+    // Loaded once for the whole batch, every delta is then computed from its payload
+    const auto config          = config_item::get_current_configs(get_self(), dac_id);
+    const auto token_config    = stake_config::get_current_configs(token_contract, dac_id);
+    const auto max_stake_time  = S{token_config.max_stake_time}.to<double>("stakeobsv max_stake_time");
+    const auto time_multiplier = S{config.time_multiplier}.to<double>("stakeobsv time_multiplier");
 
-    // Forward all the stake notifications to allow custodian contract to forbid unstaking for a custodian
-    if (custodian_contract) {
-        action(permission_level{get_self(), "notify"_n}, *custodian_contract, "stakeobsv"_n,
-            make_tuple(stake_deltas, dac_id))
-            .send();
-    }
+    auto stake_weight_deltas = vector<account_stake_weight_delta>{};
+    auto weights             = weight_table{get_self(), dac_id.value};
 
-    auto weight_deltas = vector<account_weight_delta>{};
-    auto weights       = weight_table{get_self(), dac_id.value};
+    // Stake of each account before this batch. weight_quorum always equals the stake, so it is only read from the
+    // token contract for accounts without a weights row yet (first stake, or staked before this contract was attached
+    // to the dac). The token contract has already applied the whole batch, hence the deltas are subtracted.
+    auto stakes = std::map<name, int64_t>{};
+    for (const auto &asd : stake_deltas) {
+        stakes[asd.account] = S{stakes[asd.account]} - S{asd.stake_delta.amount};
+    }
+    const auto token_stakes = stakes_table{token_contract, dac_id.value};
+    for (auto &[account, stake] : stakes) {
+        const auto weight_itr = weights.find(account.value);
+        if (weight_itr != weights.end()) {
+            stake = S{weight_itr->weight_quorum}.to<int64_t>();
+        } else {
+            const auto stakes_itr = token_stakes.find(account.value);
+            if (stakes_itr != token_stakes.end()) {
+                stake = S{stake} + S{(stakes_itr->stake).amount};
+            }
+        }
+    }
 
     for (const auto &asd : stake_deltas) {
+        auto &stake = stakes[asd.account];
+        stake       = S{stake} + S{asd.stake_delta.amount};
+        check(stake >= int64_t{}, "ERR::NEGATIVE_STAKE::Stake delta %s would leave %s with a negative stake",
+            asd.stake_delta, asd.account);
+
         // Destructured variables cannot be captured by reference in a lambda. That's why we are forced to use std::tie
         int64_t weight_delta;
         int64_t weight_quorum_delta;
-        std::tie(weight_delta, weight_quorum_delta) = calculate_weight_and_quorum_deltas(asd.account, dac_id);
+        std::tie(weight_delta, weight_quorum_delta) = calculate_weight_and_quorum_deltas(
+            asd.account, stake, asd.unstake_delay, weights, time_multiplier, max_stake_time);
 
-        weight_deltas.push_back({asd.account, weight_delta, weight_quorum_delta});
+        stake_weight_deltas.push_back(
+            {asd.account, asd.stake_delta, asd.unstake_delay, weight_delta, weight_quorum_delta});
 
         auto vw_itr = weights.find(asd.account.value);
         upsert(weights, vw_itr, get_self(), [&](auto &v) {
@@ -45,10 +67,11 @@ void stakevote::stakeobsv(const vector<account_stake_delta> &stake_deltas, const
         }
     }
 
-    // Send weightobsv to update the vote weights, update weights table
+    // Forward the stake deltas (so the custodian contract can forbid unstaking for a custodian) together with the
+    // resulting weight deltas in a single notification.
     if (custodian_contract) {
-        action(permission_level{get_self(), "notify"_n}, *custodian_contract, "weightobsv"_n,
-            make_tuple(weight_deltas, dac_id))
+        action(permission_level{get_self(), "notify"_n}, *custodian_contract, "stakewtobsv"_n,
+            make_tuple(stake_weight_deltas, dac_id))
             .send();
     }
 }
@@ -83,33 +106,28 @@ void stakevote::updateconfig(config_item &new_config, const name dac_id) {
 }
 
 /**
- * @brief Calculate the vote weight and vote quorum of an account based on the current stake, time multiplier, unstake
- * delay, and max stake time.
+ * @brief Calculate the vote weight and vote quorum deltas of an account based on its new stake, time multiplier,
+ * unstake delay, and max stake time. Reads nothing but the weights row of the account.
  *
  * @param account
- * @param dac_id
+ * @param stake the stake of the account after the delta
+ * @param unstake_delay the unstake delay carried by the delta
+ * @param weights the weights table of the dac
+ * @param time_multiplier from the config of this contract
+ * @param max_stake_time from the stake config of the token contract
  * @return returns a std::pair of [weight_delta, weight_quorum_delta].
  */
-std::pair<int64_t, int64_t> stakevote::calculate_weight_and_quorum_deltas(const name account, const name dac_id) {
-    const auto dac             = dacdir::dac_for_id(dac_id);
-    const auto token_contract  = dac.symbol.get_contract();
-    const auto stakes          = stakes_table{token_contract, dac_id.value};
-    const auto config          = config_item::get_current_configs(get_self(), dac_id);
-    const auto token_config    = stake_config::get_current_configs(token_contract, dac_id);
-    const auto max_stake_time  = S{token_config.max_stake_time}.to<double>();
-    const auto time_multiplier = S{config.time_multiplier}.to<double>();
-
-    const auto stakes_itr = stakes.find(account.value);
-
-    const auto new_weight_quorum = stakes_itr != stakes.end() ? S{(stakes_itr->stake).amount} : S{int64_t{}};
+std::pair<int64_t, int64_t> stakevote::calculate_weight_and_quorum_deltas(const name account, const int64_t stake,
+    const uint32_t unstake_delay, const weight_table &weights, const S<double> time_multiplier,
+    const S<double> max_stake_time) {
+    const auto new_weight_quorum = S{stake};
 
     // calculate new weight and weight_quorum
-    const auto stake_amount  = new_weight_quorum.to<double>();
-    const auto unstake_delay = S{staketime_info::get_delay(token_contract, dac_id, stakes_itr->account)}.to<double>();
-    const auto new_weight    = stake_amount * (S{1.0} + unstake_delay * time_multiplier / max_stake_time);
+    const auto stake_amount = new_weight_quorum.to<double>();
+    const auto delay        = S{unstake_delay}.to<double>();
+    const auto new_weight   = stake_amount * (S{1.0} + delay * time_multiplier / max_stake_time);
 
     // calculate deltas
-    const auto weights           = weight_table{get_self(), dac_id.value};
     const auto weight_itr        = weights.find(account.value);
     const auto old_weight        = S{weight_itr != weights.end() ? weight_itr->weight : uint64_t{}};
     const auto old_weight_quorum = S{weight_itr != weights.end() ? weight_itr->weight_quorum : uint64_t{}};
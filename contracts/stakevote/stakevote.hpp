@@ -61,7 +61,9 @@ CONTRACT stakevote : public contract {
         return new_weight < int64_t{0};
     }
 
-    std::pair<int64_t, int64_t> calculate_weight_and_quorum_deltas(const name account, const name dac_id);
+    std::pair<int64_t, int64_t> calculate_weight_and_quorum_deltas(const name account, const int64_t stake,
+        const uint32_t unstake_delay, const weight_table &weights, const S<double> time_multiplier,
+        const S<double> max_stake_time);
 
     struct [[eosio::table("stakes"), eosio::contract("eosdactokens")]] stake_info {
         name  account;
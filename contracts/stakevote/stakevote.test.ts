@@ -741,7 +741,7 @@ async function setup_permissions() {
     shared.stakevote_contract,
     'notify',
     shared.daccustodian_contract,
-    ['stakeobsv', 'weightobsv']
+    ['stakeobsv', 'weightobsv', 'stakewtobsv']
   );
 }
 